@@ -29,6 +29,7 @@
 #include <QMap>
 #include <QVector>
 #include <QPair>
+#include <functional>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
@@ -48,6 +49,7 @@ private slots:
     void openImage();
     void detectDefects();
     void openFolder();
+    void openArchive();
     void batchDetect();
     void openVideo();
     void openCamera();
@@ -65,6 +67,10 @@ private:
     bool runRKNNInference(const QImage &inputImage, QImage &outputImage, object_detect_result_list *od_results = nullptr);
     void displayResult(const QImage &image);
     void processFolder(const QString &folderPath);
+    void processArchive(const QString &archivePath);
+    // 按 index 取第 index 张图片，name 返回用于显示和统计的名称
+    typedef std::function<QImage(int index, QString &name)> BatchImageLoader;
+    void processBatch(const QString &sourcePath, const QString &outputDir, int count, const BatchImageLoader &loadImageAt);
     QStringList findImageFiles(const QString &folderPath);
     bool saveResultImage(const QImage &image, const QString &originalPath);
         QImage videoFrameToImage(const QVideoFrame &frame);
@@ -77,6 +83,7 @@ private:
     QPushButton *openButton;
     QPushButton *detectButton;
     QPushButton *openFolderButton;
+    QPushButton *openArchiveButton;
     QPushButton *batchDetectButton;
     QPushButton *prevImageButton;
     QPushButton *nextImageButton;
@@ -99,6 +106,8 @@ private:
     QString currentImagePath;
     // 当前选择的文件夹路径（用于批量检测）
     QString currentFolderPath;
+    // 当前选择的数据包路径（rknn_image_pack 打包，优先于文件夹）
+    QString currentArchivePath;
     // 当前视频路径
     QString currentVideoPath;
     // 当前文件夹中的图片列表
@@ -21,6 +21,8 @@
 #include "yolov6.h"
 #include "postprocess.h"
 #include "image_utils.h"
+#include "image_buffer_pool.h"
+#include "image_archive.h"
 #include "file_utils.h"
 #include "common.h"
 #include <vector>
@@ -132,6 +134,7 @@ void MainWindow::setupUI()
     openButton = new QPushButton("打开图片");
     detectButton = new QPushButton("开始检测");
     openFolderButton = new QPushButton("选择文件夹");
+    openArchiveButton = new QPushButton("打开数据包");
     batchDetectButton = new QPushButton("批量检测");
     showStatsButton = new QPushButton("查看统计");
     prevImageButton = new QPushButton("上一张");
@@ -152,6 +155,7 @@ void MainWindow::setupUI()
     openButton->setFixedWidth(120);
     detectButton->setFixedWidth(120);
     openFolderButton->setFixedWidth(120);
+    openArchiveButton->setFixedWidth(120);
     batchDetectButton->setFixedWidth(120);
     showStatsButton->setFixedWidth(120);
     prevImageButton->setFixedWidth(120);
@@ -184,7 +188,7 @@ void MainWindow::setupUI()
 
     // 创建功能分组
     QWidget *imageGroup = createButtonGroup({openButton, detectButton});
-    QWidget *folderGroup = createButtonGroup({openFolderButton, batchDetectButton, showStatsButton, prevImageButton, nextImageButton});
+    QWidget *folderGroup = createButtonGroup({openFolderButton, openArchiveButton, batchDetectButton, showStatsButton, prevImageButton, nextImageButton});
     QWidget *videoGroup = createButtonGroup({openVideoButton, inferenceButton});
     QWidget *cameraGroup = createButtonGroup({openCameraButton});
 
@@ -262,6 +266,7 @@ void MainWindow::setupUI()
     connect(openButton, &QPushButton::clicked, this, &MainWindow::openImage);
     connect(detectButton, &QPushButton::clicked, this, &MainWindow::detectDefects);
     connect(openFolderButton, &QPushButton::clicked, this, &MainWindow::openFolder);
+    connect(openArchiveButton, &QPushButton::clicked, this, &MainWindow::openArchive);
     connect(batchDetectButton, &QPushButton::clicked, this, &MainWindow::batchDetect);
     connect(showStatsButton, &QPushButton::clicked, this, &MainWindow::showStatistics);
     connect(prevImageButton, &QPushButton::clicked, this, &MainWindow::showPreviousImage);
@@ -431,17 +436,21 @@ bool MainWindow::runRKNNInference(const QImage &inputImage, QImage &outputImage,
     QImage rgbImage = inputImage.convertToFormat(QImage::Format_RGB888);
     src_image.width = rgbImage.width();
     src_image.height = rgbImage.height();
+    src_image.width_stride = (rgbImage.width() + 15) / 16 * 16;   // 行跨距对齐后RGA可直接使用
     src_image.format = IMAGE_FORMAT_RGB888;
-    src_image.virt_addr = (unsigned char*)malloc(rgbImage.width() * rgbImage.height() * 3);
-    src_image.size = rgbImage.width() * rgbImage.height() * 3;
 
-    if (src_image.virt_addr == NULL) {
+    // 从缓冲池分配，有 DMA heap 时RGA/NPU直接通过fd访问
+    if (alloc_image_buffer(&src_image) != 0) {
         spdlog::error("分配图像缓冲区内存失败");
         return false;
     }
 
-    // 复制QImage数据到图像缓冲区
-    memcpy(src_image.virt_addr, rgbImage.constBits(), src_image.size);
+    // 按行复制QImage数据到图像缓冲区(QImage 行按4字节对齐)
+    sync_image_for_cpu(&src_image);
+    for (int y = 0; y < rgbImage.height(); y++) {
+        memcpy(src_image.virt_addr + (size_t)y * src_image.width_stride * 3, rgbImage.constScanLine(y), rgbImage.width() * 3);
+    }
+    sync_image_for_device(&src_image);
 
     // 运行RKNN推理
     object_detect_result_list local_od_results;
@@ -451,9 +460,7 @@ bool MainWindow::runRKNNInference(const QImage &inputImage, QImage &outputImage,
     if (ret != 0) {
         spdlog::error("RKNN推理失败，返回码: {}", ret);
         // 释放图像内存
-        if (src_image.virt_addr != NULL) {
-            free(src_image.virt_addr);
-        }
+        free_image_buffer(&src_image);
         return false;
     }
 
@@ -490,9 +497,7 @@ bool MainWindow::runRKNNInference(const QImage &inputImage, QImage &outputImage,
     painter.end();
 
     // 释放图像内存
-    if (src_image.virt_addr != NULL) {
-        free(src_image.virt_addr);
-    }
+    free_image_buffer(&src_image);
 
     return true;
 }
@@ -579,6 +584,7 @@ void MainWindow::openFolder()
 
         statusLabel->setText(QString(" 已选择文件夹: %1 (%2 张图片)").arg(QFileInfo(folderPath).fileName()).arg(imageFiles.size()));
         currentFolderPath = folderPath; // 保存文件夹路径
+        currentArchivePath.clear();
         currentImageList = imageFiles;  // 保存图片列表
         currentImageIndex = 0;          // 重置索引
 
@@ -591,10 +597,47 @@ void MainWindow::openFolder()
     }
 }
 
+void MainWindow::openArchive()
+{
+    QString archivePath = QFileDialog::getOpenFileName(this,
+        tr("选择图片数据包"),
+        "",
+        tr("图片数据包 (*.rkpack);;所有文件 (*.*)"));
+
+    if (archivePath.isEmpty()) {
+        return;
+    }
+
+    image_archive_t archive;
+    if (open_image_archive(archivePath.toUtf8().constData(), &archive) != 0) {
+        QMessageBox::warning(this, "错误", "无法打开数据包，文件不是有效的图片数据包");
+        return;
+    }
+    int count = archive.count;
+    close_image_archive(&archive);
+    if (count == 0) {
+        QMessageBox::warning(this, "警告", "数据包中没有图片");
+        return;
+    }
+
+    statusLabel->setText(QString(" 已选择数据包: %1 (%2 张图片)").arg(QFileInfo(archivePath).fileName()).arg(count));
+    currentArchivePath = archivePath;
+    currentFolderPath.clear();
+    currentImageList.clear();
+    currentImageIndex = -1;
+    prevImageButton->setEnabled(false);
+    nextImageButton->setEnabled(false);
+}
+
 void MainWindow::batchDetect()
 {
+    if (!currentArchivePath.isEmpty()) {
+        processArchive(currentArchivePath);
+        return;
+    }
+
     if (currentFolderPath.isEmpty() || !QFileInfo(currentFolderPath).isDir()) {
-        QMessageBox::warning(this, "错误", "请先选择包含图片的文件夹");
+        QMessageBox::warning(this, "错误", "请先选择包含图片的文件夹或数据包");
         return;
     }
 
@@ -630,35 +673,82 @@ void MainWindow::processFolder(const QString &folderPath)
         return;
     }
 
+    // 在文件夹中创建结果输出目录
+    QDir dir(folderPath);
+    QString outputDir = dir.absolutePath() + "/results";
+    if (!dir.exists(outputDir)) {
+        dir.mkdir(outputDir);
+    }
+
+    processBatch(folderPath, outputDir, imageFiles.size(), [&imageFiles](int index, QString &name) {
+        name = imageFiles[index];
+        return QImage(name);
+    });
+}
+
+void MainWindow::processArchive(const QString &archivePath)
+{
+    image_archive_t archive;
+    if (open_image_archive(archivePath.toUtf8().constData(), &archive) != 0) {
+        QMessageBox::warning(this, "错误", "无法打开数据包");
+        return;
+    }
+
+    // 结果输出到数据包旁边的 <数据包名>_results 目录
+    QFileInfo archiveInfo(archivePath);
+    QDir dir = archiveInfo.absoluteDir();
+    QString outputDir = dir.absolutePath() + "/" + archiveInfo.completeBaseName() + "_results";
+    if (!dir.exists(outputDir)) {
+        dir.mkdir(outputDir);
+    }
+
+    // 图片数据直接取自映射的数据包，不再逐个打开文件
+    processBatch(archivePath, outputDir, archive.count, [&archive](int index, QString &name) {
+        const image_archive_entry_t *entry = &archive.entries[index];
+        size_t size = 0;
+        const unsigned char *data = get_image_archive_data(&archive, index, &size);
+        name = QString::fromUtf8(get_image_archive_name(&archive, index));
+        if (entry->type != IMAGE_ARCHIVE_RAW) {
+            return QImage::fromData(data, (int)size);
+        }
+        // 原始像素: 直接引用映射内存，数据包关闭前有效
+        if (entry->format == IMAGE_FORMAT_RGB888 && size >= (size_t)entry->width * entry->height * 3) {
+            return QImage(data, entry->width, entry->height, entry->width * 3, QImage::Format_RGB888);
+        }
+        if (entry->format == IMAGE_FORMAT_GRAY8 && size >= (size_t)entry->width * entry->height) {
+            return QImage(data, entry->width, entry->height, entry->width, QImage::Format_Grayscale8);
+        }
+        return QImage();
+    });
+
+    close_image_archive(&archive);
+}
+
+void MainWindow::processBatch(const QString &sourcePath, const QString &outputDir, int count, const BatchImageLoader &loadImageAt)
+{
     // 清空统计数据，开始新的统计
     batchStats.clear();
-    spdlog::info("开始批量检测统计，文件夹: {}", folderPath.toStdString());
+    spdlog::info("开始批量检测统计: {}", sourcePath.toStdString());
 
     
     // 创建进度对话框
-    QProgressDialog progressDialog("正在批量处理图片...", "取消", 0, imageFiles.size(), this);
+    QProgressDialog progressDialog("正在批量处理图片...", "取消", 0, count, this);
     progressDialog.setWindowModality(Qt::WindowModal);
     progressDialog.setWindowTitle("批量检测进度");
     progressDialog.setMinimumDuration(0);
 
-    // 在文件夹中创建结果输出目录
-    QDir dir(folderPath);
-    QString outputDir = dir.absolutePath() + "/results";
-    if (!dir.exists(outputDir)) {
-        dir.mkdir(outputDir);
-    }
-
     int successCount = 0;
     int failCount = 0;
 
-    for (int i = 0; i < imageFiles.size(); ++i) {
+    for (int i = 0; i < count; ++i) {
         // 检查是否取消
         if (progressDialog.wasCanceled()) {
             statusLabel->setText("批量检测已取消");
             break;
         }
 
-        QString imagePath = imageFiles[i];
+        QString imagePath;
+        QImage inputImage = loadImageAt(i, imagePath);
         QFileInfo fileInfo(imagePath);
 
         // 更新进度
@@ -668,11 +758,10 @@ void MainWindow::processFolder(const QString &folderPath)
 
         statusLabel->setText(QString(" 正在处理 %1/%2: %3")
                            .arg(i + 1)
-                           .arg(imageFiles.size())
+                           .arg(count)
                            .arg(fileInfo.fileName()));
 
         // 处理单张图片
-        QImage inputImage(imagePath);
         if (inputImage.isNull()) {
             spdlog::warn("无法读取图片: {}", imagePath.toStdString());
             failCount++;
@@ -705,13 +794,13 @@ void MainWindow::processFolder(const QString &folderPath)
         }
 
         // 定期更新界面显示最后处理的结果
-        if (i % 5 == 0 || i == imageFiles.size() - 1) {
+        if (i % 5 == 0 || i == count - 1) {
             displayResult(outputImage);
             QApplication::processEvents();
         }
     }
 
-    progressDialog.setValue(imageFiles.size());
+    progressDialog.setValue(count);
 
     // 启用统计按钮
     showStatsButton->setEnabled(true);
@@ -0,0 +1,65 @@
+#ifndef _RKNN_DEMO_BATCH_PIPELINE_H_
+#define _RKNN_DEMO_BATCH_PIPELINE_H_
+
+#include "image_archive.h"
+#include "result_sink.h"
+#include "yolov6_pool.h"
+
+// 批量处理流水线:
+//   push -> [输入队列] -> 解码线程 x N -> [推理队列] -> 推理线程(与上下文数相同，
+//   预处理直接 letterbox 到上下文空闲的输入张量，与NPU上的上一帧重叠；
+//   同时有多个空闲上下文和排队的图片时，letterbox 合并为一个 RGA 任务提交)
+//   -> [后处理队列] -> 后处理线程(按输入顺序输出结果) -> [写出队列] -> 写出线程 x M
+// 没有画框图片要写的结果直接在后处理线程释放，不经过写出线程。
+// 所有队列有界，在途图片数也有上限，慢的阶段会反压前面的阶段。
+
+// 画框结果图片的保存策略
+#define BATCH_SAVE_ALL      0
+#define BATCH_SAVE_DETECTED 1   // 只保存有检测结果的图片
+#define BATCH_SAVE_NONE     2
+
+// 画框结果图片的文件名前缀
+#define BATCH_OUTPUT_PREFIX "out_"
+
+// 每张图片的结果输出后，在后处理线程上按输入顺序回调，od_results 为 NULL 表示处理失败。
+// 回调时图片已经解码完，源文件可以移动或删除。
+typedef void (*batch_done_callback_t)(void* user_data, const char* path, int width, int height,
+                                      const object_detect_result_list* od_results);
+
+typedef struct {
+    int decode_threads;     // 解码线程数
+    int writer_threads;     // 画框+编码写出线程数
+    int queue_depth;        // 每个队列的深度
+    int infer_batch;        // 合并为一个 RGA 任务的最大帧数 (1 ~ IMAGE_CONVERT_BATCH_MAX)，1 为逐帧提交
+    int decode_width;       // 大于 0 时 JPEG 按该尺寸缩小解码，见 read_image_scaled
+    int decode_height;
+    int decode_flags;       // IMAGE_DECODE_*
+    int save_images;        // BATCH_SAVE_*
+    const char* output_dir; // 画框图片的输出目录，NULL 为当前目录
+    const char* input_root; // 在该目录下的图片，画框图片保留相对它的子目录，避免不同子目录的同名文件互相覆盖
+    result_sink_t* sink;    // 非 NULL 时按输入顺序写入检测结果
+    batch_done_callback_t on_done;
+    void* user_data;
+} batch_pipeline_config_t;
+
+typedef struct _batch_pipeline_t batch_pipeline_t;
+
+void init_batch_pipeline_config(batch_pipeline_config_t* config);
+
+// 启动流水线，推理线程数等于上下文池的大小
+int init_batch_pipeline(yolov6_pool_t* pool, const batch_pipeline_config_t* config, batch_pipeline_t** pipe);
+
+// 提交一张图片（路径会被复制），在途图片达到上限时阻塞
+int batch_pipeline_push(batch_pipeline_t* pipe, const char* path);
+
+// 提交数据包中的第 index 张图片，解码线程直接从映射的数据包读取，条目名作为图片路径输出。
+// archive 要在 release_batch_pipeline 返回后才能关闭
+int batch_pipeline_push_archive(batch_pipeline_t* pipe, const image_archive_t* archive, int index);
+
+// 关闭输入，等待已提交的图片全部处理完后释放流水线，返回处理失败的图片数
+int release_batch_pipeline(batch_pipeline_t* pipe);
+
+// 在图片上画检测框和类别（灰度图有结果时先扩展为 RGB），检测框按解码尺寸换算
+int draw_detect_results(image_buffer_t* img, object_detect_result_list* od_results);
+
+#endif //_RKNN_DEMO_BATCH_PIPELINE_H_
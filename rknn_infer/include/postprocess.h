@@ -10,10 +10,44 @@
 #define OBJ_NAME_MAX_SIZE 64
 #define OBJ_NUMB_MAX_SIZE 128
 #define OBJ_CLASS_NUM 6
+#define OBJ_CLASS_MAX 80		// 类别数由模型输出决定，标签最多读取这么多
 #define NMS_THRESH 0.45			// 降低NMS阈值，减少重复框
 #define BOX_THRESH 0.5			// 提高置信度阈值，减少误检
+#define NMS_MAX_CANDIDATES 1024	// 进入NMS的候选框上限，按分数保留最高的
+#define NMS_GRID_MIN_BOXES 64	// 单个类别候选超过该数量时用网格划分空间
+#define NMS_GRID_CELL 32		// NMS网格边长 (模型输入坐标，像素)
 
-// class rknn_app_context_t;
+typedef struct _rknn_app_context_t rknn_app_context_t;
+
+// 量化输出张量的查找表，按量化值的原始字节索引，模型初始化时按 zp/scale 生成
+typedef struct {
+    float dequant[256];
+    float exp[256];         // exp(dequant)，DFL 的 softmax 直接查表
+} qnt_lut_t;
+
+// 后处理候选框缓冲区 (SoA)，按模型所有分支的网格总数一次分配，之后每帧复用
+typedef struct {
+    int capacity;           // 候选框上限 = 所有分支网格数之和
+    int num_class;
+    float* x1;
+    float* y1;
+    float* x2;
+    float* y2;
+    float* score;
+    int* cls;
+    int* cells;             // 单个分支内通过阈值的网格
+    int* order;             // 按分数排序后的候选
+    int* bucketed;          // 按类别分桶后的候选
+    int* kept;              // 当前类别已保留的候选
+    char* keep;             // NMS 结果
+    int* bucket_start;
+    int* bucket_fill;
+    // NMS 空间网格
+    int grid_w;
+    int grid_h;
+    int* grid_head;
+    int* grid_next;
+} post_process_buf_t;
 
 typedef struct {
     image_rect_t box;
@@ -30,6 +64,9 @@ typedef struct {
 int init_post_process();
 void deinit_post_process();
 char *coco_cls_to_name(int cls_id);
+int init_qnt_luts(rknn_app_context_t *app_ctx);
+int init_post_process_buf(rknn_app_context_t *app_ctx);
+void release_post_process_buf(rknn_app_context_t *app_ctx);
 int post_process(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter_box, float conf_threshold, float nms_threshold, object_detect_result_list *od_results);
 
 void deinitPostProcess();
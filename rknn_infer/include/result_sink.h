@@ -0,0 +1,53 @@
+#ifndef _RKNN_DEMO_RESULT_SINK_H_
+#define _RKNN_DEMO_RESULT_SINK_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "postprocess.h"
+
+// 检测结果输出格式
+#define RESULT_SINK_NONE   0
+#define RESULT_SINK_JSONL  1    // 每张图片一行 JSON
+#define RESULT_SINK_CSV    2    // 每个检测框一行，没有检测框的图片输出一行空结果
+#define RESULT_SINK_BINARY 3    // 文件头 + 每张图片一条记录
+
+// 二进制格式: result_file_header_t，之后每张图片一个 result_record_header_t，
+// 紧跟 count 个 object_detect_result (count 为 -1 表示该图片处理失败)。
+// 所有字段为本机字节序（RK3588 为小端）。
+#define RESULT_BINARY_MAGIC   0x54445452      // "RTDT"
+#define RESULT_BINARY_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;       // sizeof(object_detect_result)
+    uint32_t reserved;
+} result_file_header_t;
+
+typedef struct {
+    int64_t image_id;           // 提交顺序，从 0 开始
+    int32_t width;              // 原图尺寸，检测框为原图坐标
+    int32_t height;
+    int32_t count;
+    int32_t reserved;
+} result_record_header_t;
+
+typedef struct {
+    FILE* fp;
+    int format;
+    long count;                 // 已写入的图片数
+} result_sink_t;
+
+// 按名称解析格式 (jsonl/csv/bin)，名称为 NULL 时按文件扩展名推断，无法识别返回 -1
+int parse_result_sink_format(const char* name, const char* path);
+
+int open_result_sink(const char* path, int format, result_sink_t* sink);
+
+// 写入一张图片的结果，od_results 为 NULL 表示处理失败
+int result_sink_write(result_sink_t* sink, long image_id, const char* image_path, int width, int height,
+                      const object_detect_result_list* od_results);
+
+int close_result_sink(result_sink_t* sink);
+
+#endif //_RKNN_DEMO_RESULT_SINK_H_
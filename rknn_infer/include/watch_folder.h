@@ -0,0 +1,16 @@
+#ifndef _RKNN_DEMO_WATCH_FOLDER_H_
+#define _RKNN_DEMO_WATCH_FOLDER_H_
+
+#include "batch_pipeline.h"
+
+typedef struct {
+    const char* done_dir;   // 非 NULL 时处理完的图片移动到该目录，启动时目录中已有的图片视为未处理
+    int sidecar;            // 为 1 时为每张图片写 <文件名>.json 结果（与图片放在同一目录）
+} watch_options_t;
+
+// 热文件夹模式: 用 inotify 监视 dir，文件写完 (IN_CLOSE_WRITE) 或移入 (IN_MOVED_TO) 后
+// 立即送入流水线。收到 SIGINT/SIGTERM 后停止监视，等待在途图片处理完再返回。
+int watch_folder(const char* dir, yolov6_pool_t* pool, batch_pipeline_config_t* config,
+                 const watch_options_t* options);
+
+#endif //_RKNN_DEMO_WATCH_FOLDER_H_
@@ -18,6 +18,11 @@
 
 #include "rknn_api.h"
 #include "common.h"
+#include "image_utils.h"
+#include "postprocess.h"
+
+#define YOLOV6_MAX_OUTPUTS 9
+
 #if defined(RV1106_1103) 
     typedef struct {
         char *dma_buf_virt_addr;
@@ -26,11 +31,13 @@
     }rknn_dma_buf;
 #endif
 
-typedef struct {
+typedef struct _rknn_app_context_t {
     rknn_context rknn_ctx;
     rknn_input_output_num io_num;
     rknn_tensor_attr* input_attrs;
     rknn_tensor_attr* output_attrs;
+    rknn_core_mask core_mask;
+    uint32_t init_flag;
 #if defined(RV1106_1103) 
     rknn_tensor_mem* input_mems[1];
     rknn_tensor_mem* output_mems[9];
@@ -40,15 +47,56 @@ typedef struct {
     int model_width;
     int model_height;
     bool is_quant;
-} rknn_app_context_t;
+    qnt_lut_t* output_luts;     // 每个输出张量一份，仅量化模型
+    post_process_buf_t* post_buf;
 
-#include "postprocess.h"
+    // 零拷贝输入: letterbox 直接写入 rknn_create_mem 分配的输入张量，
+    // 两块交替使用，使下一帧预处理不会覆盖NPU正在读取的输入
+    rknn_tensor_mem* npu_input_mems[2];
+    image_buffer_t npu_input_bufs[2];      // 缓冲池的 DMA 缓冲，未使用时 virt_addr 为 NULL
+    rknn_tensor_attr npu_input_attr;
+    int npu_input_idx;
+    int npu_input_bound;
+
+    // 零拷贝输出: 常驻输出张量，未启用时为 NULL，走 rknn_outputs_get
+    rknn_tensor_mem* npu_output_mems[YOLOV6_MAX_OUTPUTS];
+    rknn_tensor_attr npu_output_attrs[YOLOV6_MAX_OUTPUTS];     // 绑定时使用的(原生)布局
+
+    // 异步推理状态: 最多一帧在NPU上运行, 一帧结果等待取走
+    image_buffer_t input_img;
+    letterbox_t pending_letterbox;
+    rknn_run_extend pending_run;
+    long pending_tag;
+    int pending;
+    long ready_tag;
+    int ready;
+    object_detect_result_list ready_results;
+
+    // 最近一帧各阶段耗时 (ms)
+    long long preprocess_time;
+    long long inference_time;
+    long long postprocess_time;
+} rknn_app_context_t;
 
 
 int init_yolov6_model(const char* model_path, rknn_app_context_t* app_ctx);
 
+// 复制已加载的模型到新上下文（共享权重），并绑定到指定的NPU核心
+int dup_yolov6_model(rknn_app_context_t* src_ctx, rknn_app_context_t* dst_ctx, rknn_core_mask core_mask);
+
 int release_yolov6_model(rknn_app_context_t* app_ctx);
 
+// 同步推理，等价于 yolov6_submit + yolov6_wait
 int inference_yolov6_model(rknn_app_context_t* app_ctx, image_buffer_t* img, object_detect_result_list* od_results);
 
+// 异步推理: submit 完成预处理后启动NPU并立即返回，若上一帧仍在NPU上则先收取其结果。
+// 每次 submit 之后需要调用一次 wait 取走结果，tag 原样返回用于对应输入帧。
+int yolov6_submit(rknn_app_context_t* app_ctx, image_buffer_t* img, long tag);
+
+int yolov6_wait(rknn_app_context_t* app_ctx, object_detect_result_list* od_results, long* tag);
+
+// 批量提交: 多个上下文各一帧，letterbox 合并为一个RGA任务后分别启动NPU。
+// 上下文不能重复；返回失败时，失败位置之前的上下文已经提交，仍需各自 wait。
+int yolov6_submit_batch(rknn_app_context_t** app_ctxs, image_buffer_t** imgs, long* tags, int count);
+
 #endif //_RKNN_DEMO_YOLOV6_H_
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef _RKNN_DEMO_YOLOV6_POOL_H_
+#define _RKNN_DEMO_YOLOV6_POOL_H_
+
+#include <pthread.h>
+
+#include "yolov6.h"
+
+#define YOLOV6_POOL_MAX_SIZE 6
+#define YOLOV6_POOL_NPU_CORES 3
+
+// 多上下文池：第一个上下文加载模型，其余通过 rknn_dup_context 复制，
+// 第 i 个上下文固定运行在 NPU 核心 i % YOLOV6_POOL_NPU_CORES 上。
+// 调度（acquire/release）不调用任何 RKNN 接口，可以脱离 NPU 单独测试。
+typedef struct {
+    rknn_app_context_t app_ctx[YOLOV6_POOL_MAX_SIZE];
+    int busy[YOLOV6_POOL_MAX_SIZE];     // 每个上下文当前被占用的任务数
+    int size;
+    int max_jobs;                       // 每个上下文允许同时占用的任务数
+    int next;                           // 负载相同时的轮询起点
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} yolov6_pool_t;
+
+// 初始化/释放调度状态，不加载模型（见 yolov6_pool_scheduler.cc）
+int init_yolov6_pool_scheduler(yolov6_pool_t* pool, int size, int max_jobs);
+
+void release_yolov6_pool_scheduler(yolov6_pool_t* pool);
+
+// 加载模型并创建 size 个上下文（1 <= size <= YOLOV6_POOL_MAX_SIZE）
+int init_yolov6_pool(const char* model_path, int size, yolov6_pool_t* pool);
+
+int release_yolov6_pool(yolov6_pool_t* pool);
+
+// 取出当前负载最低的上下文，所有上下文都满载时阻塞等待
+rknn_app_context_t* yolov6_pool_acquire(yolov6_pool_t* pool);
+
+// 非阻塞版本，所有上下文都满载时返回 NULL
+rknn_app_context_t* yolov6_pool_try_acquire(yolov6_pool_t* pool);
+
+void yolov6_pool_release(yolov6_pool_t* pool, rknn_app_context_t* app_ctx);
+
+#endif //_RKNN_DEMO_YOLOV6_POOL_H_
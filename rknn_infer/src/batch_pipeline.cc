@@ -0,0 +1,777 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "batch_pipeline.h"
+#include "file_utils.h"
+#include "image_buffer_pool.h"
+#include "image_drawing.h"
+
+#define BATCH_PIPELINE_MAX_THREADS 16
+
+typedef struct {
+    long seq;                   // 提交顺序，输出按该顺序排列
+    char *path;                 // 数据包中的图片为条目名
+    const image_archive_t *archive; // 非 NULL 时从数据包第 archive_index 项解码
+    int archive_index;
+    image_buffer_t image;
+    object_detect_result_list results;
+    int status;                 // 0: 成功; -1: 读取失败; -2: 推理失败
+    long long decode_time;
+    long long infer_time;       // 预处理 + NPU + 后处理
+} pipeline_job_t;
+
+// 有界阻塞队列，close 之后 pop 取完剩余任务返回 NULL
+typedef struct {
+    pipeline_job_t **items;
+    int capacity;
+    int head;
+    int count;
+    int closed;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} job_queue_t;
+
+struct _batch_pipeline_t {
+    yolov6_pool_t *pool;
+    batch_pipeline_config_t config;
+
+    job_queue_t input_queue;
+    job_queue_t infer_queue;
+    job_queue_t post_queue;
+    job_queue_t write_queue;
+
+    pthread_t decode_threads[BATCH_PIPELINE_MAX_THREADS];
+    pthread_t infer_threads[YOLOV6_POOL_MAX_SIZE];
+    pthread_t post_thread;
+    pthread_t writer_threads[BATCH_PIPELINE_MAX_THREADS];
+    int decode_started;
+    int infer_started;
+    int post_started;
+    int writer_started;
+
+    // 在途图片数上限，同时也是重排窗口的大小
+    pthread_mutex_t lock;
+    pthread_cond_t inflight_cond;
+    int inflight;
+    int max_inflight;
+    long next_seq;
+
+    // 每个上下文已在NPU上启动、结果还没收取的那一帧，只由当前持有该上下文的推理线程访问
+    pipeline_job_t *pending_jobs[YOLOV6_POOL_MAX_SIZE];
+    long long pending_submit[YOLOV6_POOL_MAX_SIZE];
+
+    // 只由后处理线程访问
+    pipeline_job_t **reorder;
+    long next_emit;
+
+    long done_count;
+    long failed_count;
+    long long start_time;
+};
+
+static long long get_current_time_ms()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (long long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+static int init_job_queue(job_queue_t *queue, int capacity)
+{
+    memset(queue, 0, sizeof(job_queue_t));
+    queue->items = (pipeline_job_t **)malloc(capacity * sizeof(pipeline_job_t *));
+    if (queue->items == NULL)
+    {
+        return -1;
+    }
+    queue->capacity = capacity;
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->not_empty, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+    return 0;
+}
+
+static void release_job_queue(job_queue_t *queue)
+{
+    if (queue->items == NULL)
+    {
+        return;
+    }
+    free(queue->items);
+    queue->items = NULL;
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_cond_destroy(&queue->not_full);
+}
+
+static void job_queue_push(job_queue_t *queue, pipeline_job_t *job)
+{
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->capacity)
+    {
+        pthread_cond_wait(&queue->not_full, &queue->lock);
+    }
+    queue->items[(queue->head + queue->count) % queue->capacity] = job;
+    queue->count++;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+static pipeline_job_t *take_job(job_queue_t *queue)
+{
+    pipeline_job_t *job = queue->items[queue->head];
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->count--;
+    pthread_cond_signal(&queue->not_full);
+    return job;
+}
+
+static pipeline_job_t *job_queue_pop(job_queue_t *queue)
+{
+    pipeline_job_t *job = NULL;
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0 && !queue->closed)
+    {
+        pthread_cond_wait(&queue->not_empty, &queue->lock);
+    }
+    if (queue->count > 0)
+    {
+        job = take_job(queue);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return job;
+}
+
+static pipeline_job_t *job_queue_try_pop(job_queue_t *queue)
+{
+    pipeline_job_t *job = NULL;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count > 0)
+    {
+        job = take_job(queue);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return job;
+}
+
+static void job_queue_close(job_queue_t *queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    queue->closed = 1;
+    pthread_cond_broadcast(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+static void free_job(batch_pipeline_t *pipe, pipeline_job_t *job)
+{
+    free_image_buffer(&job->image);
+    free(job->path);
+    free(job);
+
+    pthread_mutex_lock(&pipe->lock);
+    pipe->inflight--;
+    pthread_cond_signal(&pipe->inflight_cond);
+    pthread_mutex_unlock(&pipe->lock);
+}
+
+// 检测框是原图坐标，缩小解码的图像上画框前按解码尺寸换算
+static void map_box_to_image(const image_buffer_t *img, int *x1, int *y1, int *x2, int *y2)
+{
+    if (img->orig_width <= img->width || img->orig_height <= 0)
+    {
+        return;
+    }
+    *x1 = *x1 * img->width / img->orig_width;
+    *x2 = *x2 * img->width / img->orig_width;
+    *y1 = *y1 * img->height / img->orig_height;
+    *y2 = *y2 * img->height / img->orig_height;
+}
+
+// 灰度图有检测结果时扩展为 RGB 再画彩色框，没有检测结果时仍按灰度保存
+static int expand_gray_for_drawing(image_buffer_t *img, int count)
+{
+    if (img->format != IMAGE_FORMAT_GRAY8 || count == 0)
+    {
+        return 0;
+    }
+    image_buffer_t rgb;
+    memset(&rgb, 0, sizeof(image_buffer_t));
+    rgb.width = img->width;
+    rgb.height = img->height;
+    rgb.width_stride = img->width_stride;
+    rgb.orig_width = img->orig_width;
+    rgb.orig_height = img->orig_height;
+    rgb.format = IMAGE_FORMAT_RGB888;
+    if (alloc_image_buffer(&rgb) != 0)
+    {
+        return -1;
+    }
+    if (convert_image(img, &rgb, NULL, NULL, 0) != 0)
+    {
+        free_image_buffer(&rgb);
+        return -1;
+    }
+    free_image_buffer(img);
+    *img = rgb;
+    return 0;
+}
+
+int draw_detect_results(image_buffer_t *img, object_detect_result_list *od_results)
+{
+    if (expand_gray_for_drawing(img, od_results->count) != 0)
+    {
+        return -1;
+    }
+    char text[256];
+    for (int i = 0; i < od_results->count; i++)
+    {
+        object_detect_result *det_result = &(od_results->results[i]);
+        int x1 = det_result->box.left;
+        int y1 = det_result->box.top;
+        int x2 = det_result->box.right;
+        int y2 = det_result->box.bottom;
+        map_box_to_image(img, &x1, &y1, &x2, &y2);
+
+        draw_rectangle(img, x1, y1, x2 - x1, y2 - y1, COLOR_BLUE, 3);
+
+        sprintf(text, "%s %.1f%%", coco_cls_to_name(det_result->cls_id), det_result->prop * 100);
+        draw_text(img, text, x1, y1 - 20, COLOR_RED, 10);
+    }
+    return 0;
+}
+
+static void *decode_thread_func(void *arg)
+{
+    batch_pipeline_t *pipe = (batch_pipeline_t *)arg;
+    const batch_pipeline_config_t *config = &pipe->config;
+    pipeline_job_t *job;
+
+    while ((job = job_queue_pop(&pipe->input_queue)) != NULL)
+    {
+        long long decode_start = get_current_time_ms();
+        int ret;
+        if (job->archive != NULL)
+        {
+            ret = read_image_from_archive(job->archive, job->archive_index, &job->image, config->decode_width,
+                                          config->decode_height, config->decode_flags);
+        }
+        else
+        {
+            ret = read_image_scaled(job->path, &job->image, config->decode_width, config->decode_height,
+                                    config->decode_flags);
+        }
+        job->decode_time = get_current_time_ms() - decode_start;
+        if (ret != 0)
+        {
+            // 失败的图片也要经过后处理线程，保证输出顺序
+            job->status = -1;
+            job_queue_push(&pipe->post_queue, job);
+            continue;
+        }
+        job_queue_push(&pipe->infer_queue, job);
+    }
+    return NULL;
+}
+
+// 收取上下文上一帧的结果并交给后处理线程
+static void finish_infer_job(batch_pipeline_t *pipe, rknn_app_context_t *app_ctx, pipeline_job_t *job,
+                             long long submit_time)
+{
+    long tag = -1;
+    int ret = yolov6_wait(app_ctx, &job->results, &tag);
+    if (ret != 0 || tag != job->seq)
+    {
+        printf("推理失败: %s (ret=%d)\n", job->path, ret);
+        job->status = -2;
+    }
+    job->infer_time = get_current_time_ms() - submit_time;
+    job_queue_push(&pipe->post_queue, job);
+}
+
+// 收取所有空闲上下文上滞留的帧。被其他推理线程占用的上下文，由该线程提交完后回到这里收取
+static void flush_idle_contexts(batch_pipeline_t *pipe)
+{
+    yolov6_pool_t *pool = pipe->pool;
+    rknn_app_context_t *app_ctxs[YOLOV6_POOL_MAX_SIZE];
+    int count = 0;
+
+    // 先全部取出再释放，否则 try_acquire 会再次拿到同一个上下文
+    while (count < pool->size && (app_ctxs[count] = yolov6_pool_try_acquire(pool)) != NULL)
+    {
+        count++;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        int idx = (int)(app_ctxs[i] - pool->app_ctx);
+        if (pipe->pending_jobs[idx] != NULL)
+        {
+            finish_infer_job(pipe, app_ctxs[i], pipe->pending_jobs[idx], pipe->pending_submit[idx]);
+            pipe->pending_jobs[idx] = NULL;
+        }
+        yolov6_pool_release(pool, app_ctxs[i]);
+    }
+}
+
+// 一次提交 count 帧，每帧占用一个上下文。多帧时 letterbox 合并为一个 RGA 任务。
+// submit 先做预处理，再收取各上下文的上一帧并启动这一帧，预处理与NPU上的上一帧重叠。
+static void submit_infer_jobs(batch_pipeline_t *pipe, rknn_app_context_t **app_ctxs, pipeline_job_t **jobs, int count)
+{
+    image_buffer_t *imgs[IMAGE_CONVERT_BATCH_MAX];
+    long tags[IMAGE_CONVERT_BATCH_MAX];
+    for (int i = 0; i < count; i++)
+    {
+        imgs[i] = &jobs[i]->image;
+        tags[i] = jobs[i]->seq;
+    }
+
+    long long submit_time = get_current_time_ms();
+    int ret = count == 1 ? yolov6_submit(app_ctxs[0], imgs[0], tags[0])
+                         : yolov6_submit_batch(app_ctxs, imgs, tags, count);
+
+    for (int i = 0; i < count; i++)
+    {
+        rknn_app_context_t *app_ctx = app_ctxs[i];
+        int idx = (int)(app_ctx - pipe->pool->app_ctx);
+        if (pipe->pending_jobs[idx] != NULL)
+        {
+            finish_infer_job(pipe, app_ctx, pipe->pending_jobs[idx], pipe->pending_submit[idx]);
+            pipe->pending_jobs[idx] = NULL;
+        }
+        // 批量提交失败时，失败位置之前的帧已经启动
+        if (ret == 0 || (app_ctx->pending && app_ctx->pending_tag == jobs[i]->seq))
+        {
+            pipe->pending_jobs[idx] = jobs[i];
+            pipe->pending_submit[idx] = submit_time;
+            continue;
+        }
+        printf("推理提交失败: %s\n", jobs[i]->path);
+        jobs[i]->status = -2;
+        job_queue_push(&pipe->post_queue, jobs[i]);
+    }
+}
+
+// 推理线程数等于上下文数，上下文不固定属于某个线程：
+// 每次取一张图片和一个最空闲的上下文，若还有空闲上下文和排队的图片，一起合并提交。
+static void *infer_thread_func(void *arg)
+{
+    batch_pipeline_t *pipe = (batch_pipeline_t *)arg;
+    yolov6_pool_t *pool = pipe->pool;
+    rknn_app_context_t *app_ctxs[IMAGE_CONVERT_BATCH_MAX];
+    pipeline_job_t *jobs[IMAGE_CONVERT_BATCH_MAX];
+
+    for (;;)
+    {
+        pipeline_job_t *job = job_queue_try_pop(&pipe->infer_queue);
+        if (job == NULL)
+        {
+            // 暂时没有新图片，先收取NPU上的帧，避免结果滞留
+            flush_idle_contexts(pipe);
+            job = job_queue_pop(&pipe->infer_queue);
+            if (job == NULL)
+            {
+                break;
+            }
+        }
+
+        int count = 1;
+        jobs[0] = job;
+        app_ctxs[0] = yolov6_pool_acquire(pool);
+        while (count < pipe->config.infer_batch)
+        {
+            rknn_app_context_t *app_ctx = yolov6_pool_try_acquire(pool);
+            if (app_ctx == NULL)
+            {
+                break;
+            }
+            job = job_queue_try_pop(&pipe->infer_queue);
+            if (job == NULL)
+            {
+                yolov6_pool_release(pool, app_ctx);
+                break;
+            }
+            app_ctxs[count] = app_ctx;
+            jobs[count] = job;
+            count++;
+        }
+
+        submit_infer_jobs(pipe, app_ctxs, jobs, count);
+        for (int i = 0; i < count; i++)
+        {
+            yolov6_pool_release(pool, app_ctxs[i]);
+        }
+    }
+    flush_idle_contexts(pipe);
+    return NULL;
+}
+
+static int need_save_image(const batch_pipeline_config_t *config, const pipeline_job_t *job)
+{
+    switch (config->save_images)
+    {
+    case BATCH_SAVE_NONE:
+        return 0;
+    case BATCH_SAVE_DETECTED:
+        return job->results.count > 0;
+    default:
+        return 1;
+    }
+}
+
+static void emit_job(batch_pipeline_t *pipe, pipeline_job_t *job)
+{
+    result_sink_t *sink = pipe->config.sink;
+    pipe->done_count++;
+    if (job->status != 0)
+    {
+        printf("[%ld] %s 处理失败\n", job->seq + 1, job->path);
+        pipe->failed_count++;
+        if (sink != NULL)
+        {
+            result_sink_write(sink, job->seq, job->path, 0, 0, NULL);
+        }
+        if (pipe->config.on_done != NULL)
+        {
+            pipe->config.on_done(pipe->config.user_data, job->path, 0, 0, NULL);
+        }
+        free_job(pipe, job);
+        return;
+    }
+
+    // 检测框是原图坐标，记录原图尺寸
+    int width = job->image.orig_width > 0 ? job->image.orig_width : job->image.width;
+    int height = job->image.orig_height > 0 ? job->image.orig_height : job->image.height;
+    if (sink != NULL && result_sink_write(sink, job->seq, job->path, width, height, &job->results) != 0)
+    {
+        printf("检测结果写入失败: %s\n", job->path);
+    }
+    if (pipe->config.on_done != NULL)
+    {
+        pipe->config.on_done(pipe->config.user_data, job->path, width, height, &job->results);
+    }
+
+    printf("[%ld] %s: %dx%d，读取 %lld ms，推理 %lld ms，检测到 %d 个目标\n", job->seq + 1, job->path,
+           job->image.width, job->image.height, job->decode_time, job->infer_time, job->results.count);
+    for (int i = 0; i < job->results.count; i++)
+    {
+        object_detect_result *det_result = &(job->results.results[i]);
+        printf("  - %s @ (%d %d %d %d) %.3f\n", coco_cls_to_name(det_result->cls_id),
+               det_result->box.left, det_result->box.top,
+               det_result->box.right, det_result->box.bottom,
+               det_result->prop);
+    }
+    if (!need_save_image(&pipe->config, job))
+    {
+        free_job(pipe, job);
+        return;
+    }
+    job_queue_push(&pipe->write_queue, job);
+}
+
+// 推理线程完成的顺序不固定，按 seq 重排后输出
+static void *post_thread_func(void *arg)
+{
+    batch_pipeline_t *pipe = (batch_pipeline_t *)arg;
+    pipeline_job_t *job;
+
+    while ((job = job_queue_pop(&pipe->post_queue)) != NULL)
+    {
+        // 在途图片的 seq 都落在 [next_emit, next_emit + max_inflight) 内，不会冲突
+        pipe->reorder[job->seq % pipe->max_inflight] = job;
+        for (;;)
+        {
+            int slot = pipe->next_emit % pipe->max_inflight;
+            pipeline_job_t *next = pipe->reorder[slot];
+            if (next == NULL || next->seq != pipe->next_emit)
+            {
+                break;
+            }
+            pipe->reorder[slot] = NULL;
+            pipe->next_emit++;
+            emit_job(pipe, next);
+        }
+    }
+    return NULL;
+}
+
+// 画框图片路径: <output_dir>/<相对 input_root 的子目录>/out_<文件名>，数据包条目名本身是相对路径。
+// 不在 input_root 下的绝对路径和含 .. 的路径只保留文件名，写出不会超出 output_dir
+static int build_output_path(const batch_pipeline_config_t *config, const char *path, char *output_path, size_t size)
+{
+    const char *relative = NULL;
+    size_t root_len = config->input_root != NULL ? strlen(config->input_root) : 0;
+    if (root_len > 0 && strncmp(path, config->input_root, root_len) == 0 &&
+        (path[root_len] == '/' || config->input_root[root_len - 1] == '/'))
+    {
+        relative = path + root_len;
+        while (*relative == '/')
+        {
+            relative++;
+        }
+    }
+    else if (path[0] != '/')
+    {
+        relative = path;
+    }
+    const char *filename = strrchr(path, '/');
+    filename = filename != NULL ? filename + 1 : path;
+    if (relative == NULL)
+    {
+        relative = filename;
+    }
+    for (const char *p = relative; p < filename; p = strchr(p, '/') + 1)
+    {
+        if (strncmp(p, "../", 3) == 0)
+        {
+            relative = filename;
+            break;
+        }
+    }
+
+    const char *output_dir = config->output_dir != NULL ? config->output_dir : ".";
+    int len = snprintf(output_path, size, "%s/%.*s" BATCH_OUTPUT_PREFIX "%s", output_dir, (int)(filename - relative),
+                       relative, filename);
+    if (len < 0 || (size_t)len >= size)
+    {
+        printf("输出路径过长: %s\n", path);
+        return -1;
+    }
+    // 输出目录本身在启动时已创建，这里只补子目录
+    if (filename > relative)
+    {
+        char *slash = strrchr(output_path, '/');
+        *slash = '\0';
+        int ret = make_directories(output_path);
+        *slash = '/';
+        if (ret != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void *writer_thread_func(void *arg)
+{
+    batch_pipeline_t *pipe = (batch_pipeline_t *)arg;
+    pipeline_job_t *job;
+
+    while ((job = job_queue_pop(&pipe->write_queue)) != NULL)
+    {
+        char output_path[PATH_MAX];
+        if (build_output_path(&pipe->config, job->path, output_path, sizeof(output_path)) != 0)
+        {
+            printf("保存图片失败: %s\n", job->path);
+            free_job(pipe, job);
+            continue;
+        }
+
+        draw_detect_results(&job->image, &job->results);
+        if (write_image(output_path, &job->image) != 0)
+        {
+            printf("保存图片失败: %s\n", output_path);
+        }
+        free_job(pipe, job);
+    }
+    return NULL;
+}
+
+void init_batch_pipeline_config(batch_pipeline_config_t *config)
+{
+    memset(config, 0, sizeof(batch_pipeline_config_t));
+    config->decode_threads = 2;
+    config->writer_threads = 2;
+    config->queue_depth = 4;
+    config->infer_batch = IMAGE_CONVERT_BATCH_MAX;
+}
+
+static void stop_batch_pipeline(batch_pipeline_t *pipe)
+{
+    // 按流水线顺序逐级关闭，前一级的线程全部退出后下游队列才不会再有新任务
+    job_queue_close(&pipe->input_queue);
+    for (int i = 0; i < pipe->decode_started; i++)
+    {
+        pthread_join(pipe->decode_threads[i], NULL);
+    }
+    job_queue_close(&pipe->infer_queue);
+    for (int i = 0; i < pipe->infer_started; i++)
+    {
+        pthread_join(pipe->infer_threads[i], NULL);
+    }
+    job_queue_close(&pipe->post_queue);
+    if (pipe->post_started)
+    {
+        pthread_join(pipe->post_thread, NULL);
+    }
+    job_queue_close(&pipe->write_queue);
+    for (int i = 0; i < pipe->writer_started; i++)
+    {
+        pthread_join(pipe->writer_threads[i], NULL);
+    }
+    pipe->decode_started = 0;
+    pipe->infer_started = 0;
+    pipe->post_started = 0;
+    pipe->writer_started = 0;
+}
+
+static void free_batch_pipeline(batch_pipeline_t *pipe)
+{
+    release_job_queue(&pipe->input_queue);
+    release_job_queue(&pipe->infer_queue);
+    release_job_queue(&pipe->post_queue);
+    release_job_queue(&pipe->write_queue);
+    pthread_mutex_destroy(&pipe->lock);
+    pthread_cond_destroy(&pipe->inflight_cond);
+    free(pipe->reorder);
+    free(pipe);
+}
+
+int init_batch_pipeline(yolov6_pool_t *pool, const batch_pipeline_config_t *config, batch_pipeline_t **pipe_out)
+{
+    if (pool == NULL || pool->size < 1 || config == NULL || pipe_out == NULL ||
+        config->decode_threads < 1 || config->decode_threads > BATCH_PIPELINE_MAX_THREADS ||
+        config->writer_threads < 1 || config->writer_threads > BATCH_PIPELINE_MAX_THREADS ||
+        config->queue_depth < 1 || config->infer_batch < 1 || config->infer_batch > IMAGE_CONVERT_BATCH_MAX)
+    {
+        printf("流水线参数错误: decode_threads=%d writer_threads=%d queue_depth=%d infer_batch=%d\n",
+               config ? config->decode_threads : 0, config ? config->writer_threads : 0,
+               config ? config->queue_depth : 0, config ? config->infer_batch : 0);
+        return -1;
+    }
+    if (config->save_images != BATCH_SAVE_NONE && config->output_dir != NULL &&
+        make_directories(config->output_dir) != 0)
+    {
+        printf("无法创建输出目录: %s\n", config->output_dir);
+        return -1;
+    }
+
+    batch_pipeline_t *pipe = (batch_pipeline_t *)calloc(1, sizeof(batch_pipeline_t));
+    if (pipe == NULL)
+    {
+        return -1;
+    }
+    pipe->pool = pool;
+    pipe->config = *config;
+    pthread_mutex_init(&pipe->lock, NULL);
+    pthread_cond_init(&pipe->inflight_cond, NULL);
+
+    // 每个阶段的队列和线程都占满时的图片数，再多只会堆在重排窗口里。
+    // 推理阶段每个上下文一帧在NPU上、一帧在提交中，另外每个推理线程可能拿着一帧在等上下文
+    int depth = config->queue_depth;
+    pipe->max_inflight = depth * 4 + config->decode_threads + pool->size * 3 + 1 + config->writer_threads;
+    pipe->reorder = (pipeline_job_t **)calloc(pipe->max_inflight, sizeof(pipeline_job_t *));
+    if (pipe->reorder == NULL ||
+        init_job_queue(&pipe->input_queue, depth) != 0 ||
+        init_job_queue(&pipe->infer_queue, depth) != 0 ||
+        init_job_queue(&pipe->post_queue, depth) != 0 ||
+        init_job_queue(&pipe->write_queue, depth) != 0)
+    {
+        printf("流水线内存分配失败!\n");
+        free_batch_pipeline(pipe);
+        return -1;
+    }
+
+    int ok = 1;
+    for (int i = 0; ok && i < config->decode_threads; i++)
+    {
+        ok = pthread_create(&pipe->decode_threads[i], NULL, decode_thread_func, pipe) == 0;
+        pipe->decode_started += ok;
+    }
+    for (int i = 0; ok && i < pool->size; i++)
+    {
+        ok = pthread_create(&pipe->infer_threads[i], NULL, infer_thread_func, pipe) == 0;
+        pipe->infer_started += ok;
+    }
+    if (ok)
+    {
+        ok = pthread_create(&pipe->post_thread, NULL, post_thread_func, pipe) == 0;
+        pipe->post_started = ok;
+    }
+    for (int i = 0; ok && i < config->writer_threads; i++)
+    {
+        ok = pthread_create(&pipe->writer_threads[i], NULL, writer_thread_func, pipe) == 0;
+        pipe->writer_started += ok;
+    }
+    if (!ok)
+    {
+        printf("流水线线程创建失败!\n");
+        stop_batch_pipeline(pipe);
+        free_batch_pipeline(pipe);
+        return -1;
+    }
+
+    printf("流水线已启动: 解码线程 %d，推理上下文 %d，写出线程 %d，队列深度 %d，RGA 合并 %d 帧\n",
+           config->decode_threads, pool->size, config->writer_threads, depth, config->infer_batch);
+    pipe->start_time = get_current_time_ms();
+    *pipe_out = pipe;
+    return 0;
+}
+
+static int submit_job(batch_pipeline_t *pipe, const char *path, const image_archive_t *archive, int index)
+{
+    pipeline_job_t *job = (pipeline_job_t *)calloc(1, sizeof(pipeline_job_t));
+    if (job == NULL)
+    {
+        return -1;
+    }
+    job->path = strdup(path);
+    if (job->path == NULL)
+    {
+        free(job);
+        return -1;
+    }
+    job->archive = archive;
+    job->archive_index = index;
+
+    pthread_mutex_lock(&pipe->lock);
+    while (pipe->inflight >= pipe->max_inflight)
+    {
+        pthread_cond_wait(&pipe->inflight_cond, &pipe->lock);
+    }
+    pipe->inflight++;
+    job->seq = pipe->next_seq++;
+    pthread_mutex_unlock(&pipe->lock);
+
+    job_queue_push(&pipe->input_queue, job);
+    return 0;
+}
+
+int batch_pipeline_push(batch_pipeline_t *pipe, const char *path)
+{
+    return submit_job(pipe, path, NULL, 0);
+}
+
+int batch_pipeline_push_archive(batch_pipeline_t *pipe, const image_archive_t *archive, int index)
+{
+    const char *name = get_image_archive_name(archive, index);
+    if (name == NULL)
+    {
+        return -1;
+    }
+    return submit_job(pipe, name, archive, index);
+}
+
+int release_batch_pipeline(batch_pipeline_t *pipe)
+{
+    if (pipe == NULL)
+    {
+        return 0;
+    }
+    stop_batch_pipeline(pipe);
+
+    long long elapsed = get_current_time_ms() - pipe->start_time;
+    printf("流水线处理完成: 共 %ld 张，失败 %ld 张，耗时 %lld ms", pipe->done_count, pipe->failed_count, elapsed);
+    if (elapsed > 0)
+    {
+        printf("，%.1f 张/秒", pipe->done_count * 1000.0 / elapsed);
+    }
+    printf("\n");
+
+    int failed = (int)pipe->failed_count;
+    free_batch_pipeline(pipe);
+    return failed;
+}
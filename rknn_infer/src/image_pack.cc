@@ -0,0 +1,199 @@
+/*-------------------------------------------
+                Includes
+-------------------------------------------*/
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "file_utils.h"
+#include "image_archive.h"
+#include "image_buffer_pool.h"
+#include "image_utils.h"
+
+typedef struct {
+    image_archive_writer_t writer;
+    const char *root;           // 当前扫描的目录，条目名为相对它的路径
+    int raw;                    // 为 1 时存解码后的像素
+    int width;                  // 大于 0 时 raw 像素缩放到该尺寸
+    int height;
+    int added;
+    int failed;
+} pack_context_t;
+
+/*-------------------------------------------
+                  Functions
+-------------------------------------------*/
+static void print_usage(const char *prog)
+{
+    printf("%s [options] <archive_path> <image_directory_or_files...>\n", prog);
+    printf("把图片打包成一个文件，按参数和文件名顺序存放，rknn_yolov6_demo 直接以数据包为输入\n");
+    printf("  --recursive          递归打包子目录\n");
+    printf("  --ext LIST           只打包这些扩展名，逗号分隔，如 .jpg,.png\n");
+    printf("  --raw                存解码后的像素 (RGB888/GRAY8)，推理时不用再解码，数据包更大\n");
+    printf("  --size WxH           存缩放到 WxH 的 RGB888 像素，隐含 --raw\n");
+}
+
+// 解码（可选缩放）后按紧密排列存入
+static int add_raw_image(pack_context_t *pack, const char *path, const char *name)
+{
+    int ret = -1;
+    image_buffer_t src_image;
+    image_buffer_t dst_image;
+    memset(&src_image, 0, sizeof(image_buffer_t));
+    memset(&dst_image, 0, sizeof(image_buffer_t));
+
+    if (read_image(path, &src_image) != 0)
+    {
+        return -1;
+    }
+    dst_image.width = pack->width > 0 ? pack->width : src_image.width;
+    dst_image.height = pack->height > 0 ? pack->height : src_image.height;
+    dst_image.format = pack->width > 0 ? IMAGE_FORMAT_RGB888 : src_image.format;
+    if (dst_image.format != IMAGE_FORMAT_RGB888 && dst_image.format != IMAGE_FORMAT_GRAY8)
+    {
+        dst_image.format = IMAGE_FORMAT_RGB888;
+    }
+    if (alloc_image_buffer(&dst_image) != 0)
+    {
+        goto out;
+    }
+    if (convert_image(&src_image, &dst_image, NULL, NULL, 0) != 0)
+    {
+        printf("convert_image fail: %s\n", path);
+        goto out;
+    }
+    sync_image_for_cpu(&dst_image);
+    ret = image_archive_add(&pack->writer, name, dst_image.virt_addr, get_image_size(&dst_image), IMAGE_ARCHIVE_RAW,
+                            dst_image.width, dst_image.height, dst_image.format,
+                            dst_image.format == IMAGE_FORMAT_GRAY8 ? 1 : 3);
+
+out:
+    free_image_buffer(&src_image);
+    free_image_buffer(&dst_image);
+    return ret;
+}
+
+static void add_entry(pack_context_t *pack, const char *path, const char *name)
+{
+    int ret = pack->raw ? add_raw_image(pack, path, name) : image_archive_add_file(&pack->writer, path, name);
+    if (ret != 0)
+    {
+        printf("跳过: %s\n", path);
+        pack->failed++;
+        return;
+    }
+    pack->added++;
+    if (pack->added % 1000 == 0)
+    {
+        printf("已打包 %d 个图片\n", pack->added);
+    }
+}
+
+static int add_directory_image(const char *path, void *user_data)
+{
+    pack_context_t *pack = (pack_context_t *)user_data;
+    size_t root_len = strlen(pack->root);
+    const char *name = path;
+    if (strncmp(path, pack->root, root_len) == 0 && path[root_len] == '/')
+    {
+        name = path + root_len + 1;
+    }
+    add_entry(pack, path, name);
+    return 0;
+}
+
+/*-------------------------------------------
+                  Main Function
+-------------------------------------------*/
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] = {
+        {"recursive", no_argument, NULL, 'r'},
+        {"ext", required_argument, NULL, 'e'},
+        {"raw", no_argument, NULL, 'R'},
+        {"size", required_argument, NULL, 's'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    pack_context_t pack;
+    memset(&pack, 0, sizeof(pack_context_t));
+    const char *extensions = NULL;
+    int walk_flags = FILE_WALK_SORTED;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'r':
+            walk_flags |= FILE_WALK_RECURSIVE;
+            break;
+        case 'e':
+            extensions = optarg;
+            break;
+        case 'R':
+            pack.raw = 1;
+            break;
+        case 's':
+            if (sscanf(optarg, "%dx%d", &pack.width, &pack.height) != 2 || pack.width <= 0 || pack.height <= 0)
+            {
+                print_usage(argv[0]);
+                return -1;
+            }
+            pack.raw = 1;
+            break;
+        default:
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+    if (argc - optind < 2)
+    {
+        print_usage(argv[0]);
+        return -1;
+    }
+
+    const char *archive_path = argv[optind];
+    if (create_image_archive(archive_path, &pack.writer) != 0)
+    {
+        return -1;
+    }
+
+    for (int i = optind + 1; i < argc; i++)
+    {
+        struct stat path_stat;
+        if (stat(argv[i], &path_stat) != 0)
+        {
+            printf("无法访问路径: %s\n", argv[i]);
+            pack.failed++;
+            continue;
+        }
+        if (S_ISDIR(path_stat.st_mode))
+        {
+            pack.root = argv[i];
+            if (walk_image_files(argv[i], extensions, walk_flags, add_directory_image, &pack) < 0)
+            {
+                pack.failed++;
+            }
+        }
+        else
+        {
+            // 单独列出的文件以文件名作为条目名
+            const char *name = strrchr(argv[i], '/');
+            add_entry(&pack, argv[i], name != NULL ? name + 1 : argv[i]);
+        }
+    }
+
+    int ret = finish_image_archive(&pack.writer);
+    release_image_buffer_pool();
+    if (ret != 0)
+    {
+        remove(archive_path);
+        return -1;
+    }
+    printf("打包完成: %s，共 %d 个图片，失败 %d 个\n", archive_path, pack.added, pack.failed);
+    return pack.failed > 0 ? 1 : 0;
+}
@@ -1,6 +1,7 @@
 /*-------------------------------------------
                 Includes
 -------------------------------------------*/
+#include <getopt.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,35 +10,51 @@
 #include <sys/time.h>
 #include <unistd.h>
 
+#include "batch_pipeline.h"
 #include "file_utils.h"
-#include "image_drawing.h"
+#include "image_archive.h"
 #include "image_utils.h"
+#include "image_buffer_pool.h"
 #include "yolov6.h"
+#include "yolov6_pool.h"
+#include "watch_folder.h"
 
 /*-------------------------------------------
-                  Main Function
+                  Functions
 -------------------------------------------*/
-int main(int argc, char **argv)
+static long get_elapsed_ms(const struct timeval *start)
 {
-    if (argc != 3)
-    {
-        printf("%s <model_path> <image_path_or_directory>\n", argv[0]);
-        return -1;
-    }
-
-    const char *model_path = argv[1];
-    const char *input_path = argv[2];
-
-    // 检查输入是文件还是目录
-    struct stat path_stat;
-    if (stat(input_path, &path_stat) != 0)
-    {
-        printf("无法访问路径: %s\n", input_path);
-        return -1;
-    }
+    struct timeval end;
+    gettimeofday(&end, NULL);
+    return (end.tv_sec - start->tv_sec) * 1000 + (end.tv_usec - start->tv_usec) / 1000;
+}
 
-    int is_directory = S_ISDIR(path_stat.st_mode);
+static void print_usage(const char *prog)
+{
+    printf("%s [options] <model_path> <image_path_or_directory_or_archive>\n", prog);
+    printf("输入为 rknn_image_pack 打包的数据包时按打包顺序批量处理，选项同目录模式\n");
+    printf("目录模式选项:\n");
+    printf("  --recursive          递归处理子目录\n");
+    printf("  --sorted             按文件名排序处理\n");
+    printf("  --ext LIST           只处理这些扩展名，逗号分隔，如 .jpg,.png\n");
+    printf("  --watch              持续监视目录，新写入或移入的图片立即处理 (不能与 --recursive/--ext 同用)\n");
+    printf("  --done-dir DIR       监视模式下处理完的图片移动到 DIR\n");
+    printf("  --sidecar            监视模式下为每张图片写 <文件名>.json\n");
+    printf("  --decode-threads N   解码线程数 (默认 2)\n");
+    printf("  --writer-threads N   画框和写出线程数 (默认 2)\n");
+    printf("  --contexts N         NPU 上下文数，1-%d (默认 %d)\n", YOLOV6_POOL_MAX_SIZE, YOLOV6_POOL_NPU_CORES);
+    printf("  --queue-depth N      各级队列深度 (默认 4)\n");
+    printf("  --rga-batch N        多个上下文空闲时合并为一个 RGA 任务的最大帧数，1-%d (默认 %d，1 为逐帧)\n",
+           IMAGE_CONVERT_BATCH_MAX, IMAGE_CONVERT_BATCH_MAX);
+    printf("  --output FILE        按输入顺序写出检测结果\n");
+    printf("  --format FMT         结果格式 jsonl|csv|bin (默认按 --output 的扩展名)\n");
+    printf("  --save-images MODE   画框图片 all|detected|none (默认 all，监视模式默认 none)\n");
+    printf("  --output-dir DIR     画框图片写到 DIR (默认当前目录)，保留输入目录下的子目录结构\n");
+}
 
+// 单张图片: 单个上下文同步推理
+static int run_single_image(const char *model_path, const char *input_path, int decode_scaled, int decode_flags)
+{
     int ret;
     rknn_app_context_t rknn_app_ctx;
     memset(&rknn_app_ctx, 0, sizeof(rknn_app_context_t));
@@ -45,10 +62,11 @@ int main(int argc, char **argv)
     image_buffer_t src_image;
     memset(&src_image, 0, sizeof(image_buffer_t));
 
-    init_post_process();
+    object_detect_result_list od_results;
+    struct timeval model_init_start, read_start, inference_start, save_start;
+    long read_time, inference_time, save_time;
 
     printf("正在初始化RKNN模型...\n");
-    struct timeval model_init_start, model_init_end;
     gettimeofday(&model_init_start, NULL);
 
     ret = init_yolov6_model(model_path, &rknn_app_ctx);
@@ -57,236 +75,394 @@ int main(int argc, char **argv)
         printf("init_yolov6_model fail! ret=%d model_path=%s\n", ret, model_path);
         goto out;
     }
+    printf("RKNN模型初始化完成，耗时: %ld ms\n", get_elapsed_ms(&model_init_start));
 
-    gettimeofday(&model_init_end, NULL);
-    long model_init_time = (model_init_end.tv_sec - model_init_start.tv_sec) * 1000 +
-                          (model_init_end.tv_usec - model_init_start.tv_usec) / 1000;
-    printf("RKNN模型初始化完成，耗时: %ld ms\n", model_init_time);
+    printf("开始处理单张图片: %s\n", input_path);
+    gettimeofday(&read_start, NULL);
 
-    if (is_directory)
+    ret = read_image_scaled(input_path, &src_image, decode_scaled ? rknn_app_ctx.model_width : 0,
+                            decode_scaled ? rknn_app_ctx.model_height : 0, decode_flags);
+    if (ret != 0)
     {
-        // 批量处理目录中的图片
-        printf("开始批量处理目录: %s\n", input_path);
+        printf("read image fail! ret=%d image_path=%s\n", ret, input_path);
+        goto out;
+    }
 
-        int image_count = 0;
-        char** image_files = get_image_files_from_directory(input_path, &image_count);
+    read_time = get_elapsed_ms(&read_start);
+    printf("图片读取完成，耗时: %ld ms，图片尺寸: %dx%d\n", read_time, src_image.width, src_image.height);
 
-        if (image_files == NULL || image_count == 0)
-        {
-            printf("在目录中未找到图片文件: %s\n", input_path);
-            goto out;
-        }
+    gettimeofday(&inference_start, NULL);
 
-        printf("找到 %d 个图片文件\n", image_count);
+    ret = inference_yolov6_model(&rknn_app_ctx, &src_image, &od_results);
 
-        for (int i = 0; i < image_count; i++)
-        {
-            printf("\n处理图片 [%d/%d]: %s\n", i + 1, image_count, image_files[i]);
+    inference_time = get_elapsed_ms(&inference_start);
+    printf("核心推理完成，耗时: %ld ms\n", inference_time);
 
-            image_buffer_t src_image;
-            memset(&src_image, 0, sizeof(image_buffer_t));
+    if (ret != 0)
+    {
+        printf("inference_yolov6_model fail! ret=%d\n", ret);
+        goto out;
+    }
 
-            // 读取图片时间统计
-            struct timeval read_start, read_end;
-            gettimeofday(&read_start, NULL);
+    // 画框和概率
+    printf("检测到 %d 个目标:\n", od_results.count);
+    for (int i = 0; i < od_results.count; i++)
+    {
+        object_detect_result *det_result = &(od_results.results[i]);
+        printf("  - %s @ (%d %d %d %d) %.3f\n", coco_cls_to_name(det_result->cls_id),
+               det_result->box.left, det_result->box.top,
+               det_result->box.right, det_result->box.bottom,
+               det_result->prop);
+    }
+    draw_detect_results(&src_image, &od_results);
 
-            ret = read_image(image_files[i], &src_image);
+    gettimeofday(&save_start, NULL);
 
-            if (ret != 0)
-            {
-                printf("读取图片失败! ret=%d image_path=%s\n", ret, image_files[i]);
-                continue;
-            }
+    ret = write_image("out.jpg", &src_image);
 
-            gettimeofday(&read_end, NULL);
-            long read_time = (read_end.tv_sec - read_start.tv_sec) * 1000 +
-                            (read_end.tv_usec - read_start.tv_usec) / 1000;
-            printf("图片读取完成，耗时: %ld ms，图片尺寸: %dx%d\n", read_time, src_image.width, src_image.height);
+    save_time = get_elapsed_ms(&save_start);
+    if (ret != 0)
+    {
+        printf("保存图片失败: out.jpg\n");
+    }
+    else
+    {
+        printf("结果已保存到: out.jpg，耗时: %ld ms\n", save_time);
+    }
 
-            // 执行推理
-            object_detect_result_list od_results;
-            struct timeval inference_start, inference_end;
-            gettimeofday(&inference_start, NULL);
+    // 计算总处理时间
+    printf("单张图片总处理时间: %ld ms\n", get_elapsed_ms(&read_start));
 
-            ret = inference_yolov6_model(&rknn_app_ctx, &src_image, &od_results);
+out:
+    if (release_yolov6_model(&rknn_app_ctx) != 0)
+    {
+        printf("release_yolov6_model fail!\n");
+    }
+    free_image_buffer(&src_image);
+    return ret;
+}
 
-            gettimeofday(&inference_end, NULL);
-            long inference_time = (inference_end.tv_sec - inference_start.tv_sec) * 1000 +
-                                (inference_end.tv_usec - inference_start.tv_usec) / 1000;
-            printf("核心推理完成，耗时: %ld ms\n", inference_time);
+static int init_batch_model(const char *model_path, int contexts, int decode_scaled, yolov6_pool_t *pool,
+                            batch_pipeline_config_t *config)
+{
+    struct timeval model_init_start;
 
-            if (ret != 0)
-            {
-                printf("推理失败! ret=%d\n", ret);
-                free(src_image.virt_addr);
-                continue;
-            }
+    printf("正在初始化RKNN模型...\n");
+    gettimeofday(&model_init_start, NULL);
+    int ret = init_yolov6_pool(model_path, contexts, pool);
+    if (ret != 0)
+    {
+        printf("init_yolov6_pool fail! ret=%d model_path=%s\n", ret, model_path);
+        return -1;
+    }
+    printf("RKNN模型初始化完成，耗时: %ld ms\n", get_elapsed_ms(&model_init_start));
 
-            // 生成输出文件名
-            char output_path[1024];
-            const char* filename = strrchr(image_files[i], '/');
-            if (filename == NULL) filename = image_files[i];
-            else filename++;
+    if (decode_scaled)
+    {
+        config->decode_width = pool->app_ctx[0].model_width;
+        config->decode_height = pool->app_ctx[0].model_height;
+    }
+    return 0;
+}
 
-            snprintf(output_path, sizeof(output_path), "out_%s", filename);
+// 监视模式: 模型常驻，处理持续写入目录的图片直到收到退出信号
+static int run_watch(const char *model_path, const char *input_path, int contexts, int decode_scaled,
+                     batch_pipeline_config_t *config, const watch_options_t *watch_options)
+{
+    yolov6_pool_t pool;
+    if (init_batch_model(model_path, contexts, decode_scaled, &pool, config) != 0)
+    {
+        return -1;
+    }
+    config->input_root = input_path;
+    int ret = watch_folder(input_path, &pool, config, watch_options);
+    release_yolov6_pool(&pool);
+    return ret;
+}
 
-            // 画框和概率
-            printf("检测到 %d 个目标:\n", od_results.count);
-            char text[256];
-            for (int j = 0; j < od_results.count; j++)
-            {
-                object_detect_result *det_result = &(od_results.results[j]);
-                printf("  - %s @ (%d %d %d %d) %.3f\n", coco_cls_to_name(det_result->cls_id),
-                       det_result->box.left, det_result->box.top,
-                       det_result->box.right, det_result->box.bottom,
-                       det_result->prop);
-                int x1 = det_result->box.left;
-                int y1 = det_result->box.top;
-                int x2 = det_result->box.right;
-                int y2 = det_result->box.bottom;
-
-                draw_rectangle(&src_image, x1, y1, x2 - x1, y2 - y1, COLOR_BLUE, 3);
-
-                sprintf(text, "%s %.1f%%", coco_cls_to_name(det_result->cls_id), det_result->prop * 100);
-                draw_text(&src_image, text, x1, y1 - 20, COLOR_RED, 10);
-            }
+static int push_to_pipeline(const char *path, void *user_data)
+{
+    if (batch_pipeline_push((batch_pipeline_t *)user_data, path) != 0)
+    {
+        printf("提交图片失败: %s\n", path);
+    }
+    return 0;
+}
 
-            // 保存结果图片
-            struct timeval save_start, save_end;
-            gettimeofday(&save_start, NULL);
+// 目录: 解码、推理、写出分别在各自的线程上流水执行，结果按文件顺序输出。
+// 边扫描目录边提交，第一张图片不用等整个目录扫描完。
+static int run_directory(const char *model_path, const char *input_path, int contexts, int decode_scaled,
+                         batch_pipeline_config_t *config, const char *extensions, int walk_flags)
+{
+    int ret;
+    yolov6_pool_t pool;
+    batch_pipeline_t *pipe = NULL;
 
-            ret = write_image(output_path, &src_image);
+    printf("开始批量处理目录: %s\n", input_path);
 
-            gettimeofday(&save_end, NULL);
-            long save_time = (save_end.tv_sec - save_start.tv_sec) * 1000 +
-                            (save_end.tv_usec - save_start.tv_usec) / 1000;
+    if (init_batch_model(model_path, contexts, decode_scaled, &pool, config) != 0)
+    {
+        return -1;
+    }
 
-            if (ret != 0)
-            {
-                printf("保存图片失败: %s\n", output_path);
-            }
-            else
-            {
-                printf("结果已保存到: %s，耗时: %ld ms\n", output_path, save_time);
-            }
+    int image_count = 0;
+    config->input_root = input_path;
+    ret = init_batch_pipeline(&pool, config, &pipe);
+    if (ret == 0)
+    {
+        image_count = walk_image_files(input_path, extensions, walk_flags, push_to_pipeline, pipe);
+        ret = release_batch_pipeline(pipe) > 0 || image_count <= 0 ? -1 : 0;
+    }
 
-            // 释放图片内存
-            if (src_image.virt_addr != NULL)
-            {
-                free(src_image.virt_addr);
-            }
+    release_yolov6_pool(&pool);
+    if (image_count == 0)
+    {
+        printf("在目录中未找到图片文件: %s\n", input_path);
+    }
+    else if (image_count > 0)
+    {
+        printf("\n批量处理完成! 共处理 %d 个图片文件\n", image_count);
+    }
+    return ret;
+}
 
-            // 计算单张图片总处理时间
-            struct timeval img_process_end;
-            gettimeofday(&img_process_end, NULL);
-            long img_process_time = (img_process_end.tv_sec - read_start.tv_sec) * 1000 +
-                                   (img_process_end.tv_usec - read_start.tv_usec) / 1000;
-            printf("单张图片总处理时间: %ld ms\n", img_process_time);
-        }
+// 数据包: 索引和图片数据都从映射的文件读取，不再逐个打开文件
+static int run_archive(const char *model_path, const char *input_path, int contexts, int decode_scaled,
+                       batch_pipeline_config_t *config)
+{
+    int ret;
+    yolov6_pool_t pool;
+    image_archive_t archive;
+    batch_pipeline_t *pipe = NULL;
 
-        // 释放文件列表内存
-        free_file_list(image_files, image_count);
-        printf("\n批量处理完成! 共处理 %d 个图片文件\n", image_count);
+    if (open_image_archive(input_path, &archive) != 0)
+    {
+        return -1;
     }
-    else
+    if (archive.count == 0)
     {
-        // 单张图片处理
-        printf("开始处理单张图片: %s\n", input_path);
-
-        struct timeval read_start, read_end;
-        gettimeofday(&read_start, NULL);
+        printf("数据包中没有图片: %s\n", input_path);
+        close_image_archive(&archive);
+        return -1;
+    }
+    printf("开始批量处理数据包: %s (%d 个图片)\n", input_path, archive.count);
 
-        ret = read_image(input_path, &src_image);
+    if (init_batch_model(model_path, contexts, decode_scaled, &pool, config) != 0)
+    {
+        close_image_archive(&archive);
+        return -1;
+    }
 
-        if (ret != 0)
+    ret = init_batch_pipeline(&pool, config, &pipe);
+    if (ret == 0)
+    {
+        for (int i = 0; i < archive.count; i++)
         {
-            printf("read image fail! ret=%d image_path=%s\n", ret, input_path);
-            goto out;
+            if (batch_pipeline_push_archive(pipe, &archive, i) != 0)
+            {
+                printf("提交图片失败: %s\n", get_image_archive_name(&archive, i));
+            }
         }
+        ret = release_batch_pipeline(pipe) > 0 ? -1 : 0;
+        printf("\n批量处理完成! 共处理 %d 个图片文件\n", archive.count);
+    }
 
-        gettimeofday(&read_end, NULL);
-        long read_time = (read_end.tv_sec - read_start.tv_sec) * 1000 +
-                        (read_end.tv_usec - read_start.tv_usec) / 1000;
-        printf("图片读取完成，耗时: %ld ms，图片尺寸: %dx%d\n", read_time, src_image.width, src_image.height);
-
-        object_detect_result_list od_results;
-
-        struct timeval inference_start, inference_end;
-        gettimeofday(&inference_start, NULL);
-
-        ret = inference_yolov6_model(&rknn_app_ctx, &src_image, &od_results);
-
-        gettimeofday(&inference_end, NULL);
-        long inference_time = (inference_end.tv_sec - inference_start.tv_sec) * 1000 +
-                            (inference_end.tv_usec - inference_start.tv_usec) / 1000;
-        printf("核心推理完成，耗时: %ld ms\n", inference_time);
+    release_yolov6_pool(&pool);
+    close_image_archive(&archive);
+    return ret;
+}
 
-        if (ret != 0)
+/*-------------------------------------------
+                  Main Function
+-------------------------------------------*/
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] = {
+        {"decode-threads", required_argument, NULL, 'd'},
+        {"writer-threads", required_argument, NULL, 'w'},
+        {"contexts", required_argument, NULL, 'c'},
+        {"queue-depth", required_argument, NULL, 'q'},
+        {"rga-batch", required_argument, NULL, 'b'},
+        {"output", required_argument, NULL, 'o'},
+        {"format", required_argument, NULL, 'f'},
+        {"save-images", required_argument, NULL, 's'},
+        {"output-dir", required_argument, NULL, 'p'},
+        {"recursive", no_argument, NULL, 'r'},
+        {"sorted", no_argument, NULL, 'O'},
+        {"ext", required_argument, NULL, 'e'},
+        {"watch", no_argument, NULL, 'W'},
+        {"done-dir", required_argument, NULL, 'D'},
+        {"sidecar", no_argument, NULL, 'S'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    batch_pipeline_config_t config;
+    init_batch_pipeline_config(&config);
+    int contexts = YOLOV6_POOL_NPU_CORES;
+    const char *output_path = NULL;
+    const char *output_format = NULL;
+    const char *extensions = NULL;
+    int walk_flags = 0;
+    int watch = 0;
+    int save_images_set = 0;
+    watch_options_t watch_options;
+    memset(&watch_options, 0, sizeof(watch_options_t));
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", long_options, NULL)) != -1)
+    {
+        switch (opt)
         {
-            printf("inference_yolov6_model fail! ret=%d\n", ret);
-            goto out;
+        case 'd':
+            config.decode_threads = atoi(optarg);
+            break;
+        case 'w':
+            config.writer_threads = atoi(optarg);
+            break;
+        case 'c':
+            contexts = atoi(optarg);
+            break;
+        case 'q':
+            config.queue_depth = atoi(optarg);
+            break;
+        case 'b':
+            config.infer_batch = atoi(optarg);
+            break;
+        case 'o':
+            output_path = optarg;
+            break;
+        case 'f':
+            output_format = optarg;
+            break;
+        case 's':
+            if (strcmp(optarg, "all") == 0)
+            {
+                config.save_images = BATCH_SAVE_ALL;
+            }
+            else if (strcmp(optarg, "detected") == 0)
+            {
+                config.save_images = BATCH_SAVE_DETECTED;
+            }
+            else if (strcmp(optarg, "none") == 0)
+            {
+                config.save_images = BATCH_SAVE_NONE;
+            }
+            else
+            {
+                print_usage(argv[0]);
+                return -1;
+            }
+            save_images_set = 1;
+            break;
+        case 'p':
+            config.output_dir = optarg;
+            break;
+        case 'r':
+            walk_flags |= FILE_WALK_RECURSIVE;
+            break;
+        case 'O':
+            walk_flags |= FILE_WALK_SORTED;
+            break;
+        case 'e':
+            extensions = optarg;
+            break;
+        case 'W':
+            watch = 1;
+            break;
+        case 'D':
+            watch_options.done_dir = optarg;
+            break;
+        case 'S':
+            watch_options.sidecar = 1;
+            break;
+        default:
+            print_usage(argv[0]);
+            return -1;
         }
+    }
+    if (argc - optind != 2)
+    {
+        print_usage(argv[0]);
+        return -1;
+    }
 
-        // 画框和概率
-        printf("检测到 %d 个目标:\n", od_results.count);
-        char text[256];
-        for (int i = 0; i < od_results.count; i++)
-        {
-            object_detect_result *det_result = &(od_results.results[i]);
-            printf("  - %s @ (%d %d %d %d) %.3f\n", coco_cls_to_name(det_result->cls_id),
-                   det_result->box.left, det_result->box.top,
-                   det_result->box.right, det_result->box.bottom,
-                   det_result->prop);
-            int x1 = det_result->box.left;
-            int y1 = det_result->box.top;
-            int x2 = det_result->box.right;
-            int y2 = det_result->box.bottom;
-
-            draw_rectangle(&src_image, x1, y1, x2 - x1, y2 - y1, COLOR_BLUE, 3);
-
-            sprintf(text, "%s %.1f%%", coco_cls_to_name(det_result->cls_id), det_result->prop * 100);
-            draw_text(&src_image, text, x1, y1 - 20, COLOR_RED, 10);
-        }
+    const char *model_path = argv[optind];
+    const char *input_path = argv[optind + 1];
 
-        struct timeval save_start, save_end;
-        gettimeofday(&save_start, NULL);
+    // 检查输入是文件还是目录
+    struct stat path_stat;
+    if (stat(input_path, &path_stat) != 0)
+    {
+        printf("无法访问路径: %s\n", input_path);
+        return -1;
+    }
 
-        ret = write_image("out.jpg", &src_image);
+    if (watch && !S_ISDIR(path_stat.st_mode))
+    {
+        printf("--watch 需要输入目录: %s\n", input_path);
+        return -1;
+    }
+    if (watch && (extensions != NULL || (walk_flags & FILE_WALK_RECURSIVE)))
+    {
+        printf("--watch 只监视目录本身的图片文件，不支持 --recursive 和 --ext\n");
+        return -1;
+    }
+    // 长时间运行时默认不写画框图片，避免占满磁盘
+    if (watch && !save_images_set)
+    {
+        config.save_images = BATCH_SAVE_NONE;
+    }
 
-        gettimeofday(&save_end, NULL);
-        long save_time = (save_end.tv_sec - save_start.tv_sec) * 1000 +
-                        (save_end.tv_usec - save_start.tv_usec) / 1000;
+    // JPEG_DECODE_SCALE=1: JPEG 按模型输入尺寸在 DCT 域缩小解码
+    // JPEG_FAST_DCT=1: 同时使用快速 IDCT 和快速色度上采样
+    const char *env_scale = getenv("JPEG_DECODE_SCALE");
+    const char *env_fast = getenv("JPEG_FAST_DCT");
+    int decode_scaled = env_scale != NULL && atoi(env_scale) > 0;
+    if (env_fast != NULL && atoi(env_fast) > 0)
+    {
+        config.decode_flags = IMAGE_DECODE_FAST_DCT | IMAGE_DECODE_FAST_UPSAMPLE;
+    }
 
-        if (ret != 0)
+    result_sink_t sink;
+    memset(&sink, 0, sizeof(result_sink_t));
+    if (output_path != NULL)
+    {
+        int format = parse_result_sink_format(output_format, output_path);
+        if (format < 0)
         {
-            printf("保存图片失败: out.jpg\n");
+            printf("不支持的结果格式: %s\n", output_format != NULL ? output_format : output_path);
+            return -1;
         }
-        else
+        if (open_result_sink(output_path, format, &sink) != 0)
         {
-            printf("结果已保存到: out.jpg，耗时: %ld ms\n", save_time);
+            return -1;
         }
-
-        // 计算总处理时间
-        struct timeval total_end;
-        gettimeofday(&total_end, NULL);
-        long total_time = (total_end.tv_sec - read_start.tv_sec) * 1000 +
-                         (total_end.tv_usec - read_start.tv_usec) / 1000;
-        printf("单张图片总处理时间: %ld ms\n", total_time);
+        config.sink = &sink;
     }
 
-out:
-    deinit_post_process();
+    init_post_process();
 
-    ret = release_yolov6_model(&rknn_app_ctx);
-    if (ret != 0)
+    if (watch)
     {
-        printf("release_yolov6_model fail! ret=%d\n", ret);
+        run_watch(model_path, input_path, contexts, decode_scaled, &config, &watch_options);
     }
-
-    if (src_image.virt_addr != NULL)
+    else if (S_ISDIR(path_stat.st_mode))
+    {
+        run_directory(model_path, input_path, contexts, decode_scaled, &config, extensions, walk_flags);
+    }
+    else if (is_image_archive(input_path))
     {
-        free(src_image.virt_addr);
+        run_archive(model_path, input_path, contexts, decode_scaled, &config);
     }
+    else
+    {
+        run_single_image(model_path, input_path, decode_scaled, config.decode_flags);
+    }
+
+    deinit_post_process();
+    close_result_sink(&sink);
+    release_image_buffer_pool();
 
     return 0;
 }
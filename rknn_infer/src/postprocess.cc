@@ -8,11 +8,10 @@
 #include <string.h>
 #include <sys/time.h>
 
-#include <set>
-#include <vector>
+#include <algorithm>
 #define LABEL_NALE_TXT_PATH "../model/neu-det_6_labels_list.txt"
 
-static char *labels[OBJ_CLASS_NUM];
+static char *labels[OBJ_CLASS_MAX];
 
 inline static int clamp(float val, int min, int max)
 {
@@ -85,7 +84,7 @@ static int readLines(const char *fileName, char *lines[], int max_line)
 
 static int loadLabelName(const char *locationFilename, char *label[])
 {
-        readLines(locationFilename, label, OBJ_CLASS_NUM);
+        readLines(locationFilename, label, OBJ_CLASS_MAX);
     return 0;
 }
 
@@ -99,77 +98,147 @@ static float CalculateOverlap(float xmin0, float ymin0, float xmax0, float ymax0
     return u <= 0.f ? 0.f : (i / u);
 }
 
-static int nms(int validCount, std::vector<float> &outputLocations, std::vector<int> classIds, std::vector<int> &order,
-               int filterId, float threshold)
+static float box_overlap(const post_process_buf_t *buf, int n, int m)
 {
+    return CalculateOverlap(buf->x1[n], buf->y1[n], buf->x2[n], buf->y2[n],
+                            buf->x1[m], buf->y1[m], buf->x2[m], buf->y2[m]);
+}
+
+// 只保留分数最高的 max_count 个候选，按分数从高到低写入 buf->order，O(n + k log k)
+static int select_top_candidates(post_process_buf_t *buf, int validCount, int max_count)
+{
+    int *order = buf->order;
+    const float *scores = buf->score;
     for (int i = 0; i < validCount; ++i)
     {
-        int n = order[i];
-        if (n == -1 || classIds[n] != filterId)
-        {
-            continue;
-        }
-        for (int j = i + 1; j < validCount; ++j)
+        order[i] = i;
+    }
+    auto higher = [scores](int a, int b)
+    { return scores[a] > scores[b] || (scores[a] == scores[b] && a < b); };
+    int count = validCount;
+    if (count > max_count)
+    {
+        std::nth_element(order, order + max_count, order + validCount, higher);
+        count = max_count;
+    }
+    std::sort(order, order + count, higher);
+    return count;
+}
+
+// 网格坐标，按 CalculateOverlap 的 +1 约定，max 一侧多算一个像素
+static int grid_index(float v, int cell, int n)
+{
+    return clamp(v / cell, 0, n - 1);
+}
+
+// 单个类别内的贪心 NMS: 候选只与已保留的框比较。候选较多时把保留的框按左上角登记到
+// 均匀网格中，查询时只看可能与候选相交的格子，相距较远的框不会计算 IoU
+static void nms_bucket(post_process_buf_t *buf, const int *order, int n, float threshold)
+{
+    int *kept = buf->kept;
+    int n_kept = 0;
+    if (n <= NMS_GRID_MIN_BOXES)
+    {
+        for (int a = 0; a < n; ++a)
         {
-            int m = order[j];
-            if (m == -1 || classIds[m] != filterId)
+            bool suppressed = false;
+            for (int k = 0; k < n_kept && !suppressed; ++k)
             {
-                continue;
+                suppressed = box_overlap(buf, kept[k], order[a]) > threshold;
             }
-            float xmin0 = outputLocations[n * 4 + 0];
-            float ymin0 = outputLocations[n * 4 + 1];
-            float xmax0 = outputLocations[n * 4 + 0] + outputLocations[n * 4 + 2];
-            float ymax0 = outputLocations[n * 4 + 1] + outputLocations[n * 4 + 3];
-
-            float xmin1 = outputLocations[m * 4 + 0];
-            float ymin1 = outputLocations[m * 4 + 1];
-            float xmax1 = outputLocations[m * 4 + 0] + outputLocations[m * 4 + 2];
-            float ymax1 = outputLocations[m * 4 + 1] + outputLocations[m * 4 + 3];
+            if (!suppressed)
+            {
+                kept[n_kept++] = order[a];
+                buf->keep[order[a]] = 1;
+            }
+        }
+        return;
+    }
 
-            float iou = CalculateOverlap(xmin0, ymin0, xmax0, ymax0, xmin1, ymin1, xmax1, ymax1);
+    const int cell = NMS_GRID_CELL;
+    int gw = buf->grid_w;
+    int gh = buf->grid_h;
+    int *head = buf->grid_head;
+    int *next = buf->grid_next;
+    int span_x = 0; // 已保留框最多跨越的格子数
+    int span_y = 0;
+    for (int g = 0; g < gw * gh; ++g)
+    {
+        head[g] = -1;
+    }
 
-            if (iou > threshold)
+    for (int a = 0; a < n; ++a)
+    {
+        int id = order[a];
+        int x0 = grid_index(buf->x1[id], cell, gw);
+        int x1 = grid_index(buf->x2[id] + 1, cell, gw);
+        int y0 = grid_index(buf->y1[id], cell, gh);
+        int y1 = grid_index(buf->y2[id] + 1, cell, gh);
+
+        // 与候选相交的保留框，左上角所在格子一定落在这个范围内
+        int qx0 = x0 - span_x > 0 ? x0 - span_x : 0;
+        int qy0 = y0 - span_y > 0 ? y0 - span_y : 0;
+        bool suppressed = false;
+        for (int gy = qy0; gy <= y1 && !suppressed; ++gy)
+        {
+            for (int gx = qx0; gx <= x1 && !suppressed; ++gx)
             {
-                order[j] = -1;
+                for (int k = head[gy * gw + gx]; k >= 0 && !suppressed; k = next[k])
+                {
+                    suppressed = box_overlap(buf, kept[k], id) > threshold;
+                }
             }
         }
+        if (suppressed)
+        {
+            continue;
+        }
+        buf->keep[id] = 1;
+        kept[n_kept] = id;
+        next[n_kept] = head[y0 * gw + x0];
+        head[y0 * gw + x0] = n_kept;
+        n_kept++;
+        span_x = x1 - x0 > span_x ? x1 - x0 : span_x;
+        span_y = y1 - y0 > span_y ? y1 - y0 : span_y;
     }
-    return 0;
 }
 
-static int quick_sort_indice_inverse(std::vector<float> &input, int left, int right, std::vector<int> &indices)
+// 按类别分桶 (计数排序，桶内保持分数顺序)，每个桶单独做 NMS，保留的候选在 buf->keep 中置 1
+static void nms_by_class(post_process_buf_t *buf, int validCount, int count, float threshold)
 {
-    float key;
-    int key_index;
-    int low = left;
-    int high = right;
-    if (left < right)
+    const int *order = buf->order;
+    int *bucket_start = buf->bucket_start;
+    int num_class = buf->num_class;
+
+    memset(buf->keep, 0, validCount * sizeof(char));
+    memset(bucket_start, 0, (num_class + 1) * sizeof(int));
+    for (int i = 0; i < count; ++i)
     {
-        key_index = indices[left];
-        key = input[left];
-        while (low < high)
+        bucket_start[buf->cls[order[i]] + 1]++;
+    }
+    for (int c = 0; c < num_class; ++c)
+    {
+        bucket_start[c + 1] += bucket_start[c];
+    }
+    // 借用 bucket_fill 记录每个桶的写入位置
+    int *fill = buf->bucket_fill;
+    memcpy(fill, bucket_start, num_class * sizeof(int));
+    for (int i = 0; i < count; ++i)
+    {
+        buf->bucketed[fill[buf->cls[order[i]]]++] = order[i];
+    }
+
+    for (int c = 0; c < num_class; ++c)
+    {
+        int n = bucket_start[c + 1] - bucket_start[c];
+        if (n > 0)
         {
-            while (low < high && input[high] <= key)
-            {
-                high--;
-            }
-            input[low] = input[high];
-            indices[low] = indices[high];
-            while (low < high && input[low] >= key)
-            {
-                low++;
-            }
-            input[high] = input[low];
-            indices[high] = indices[low];
+            nms_bucket(buf, &buf->bucketed[bucket_start[c]], n, threshold);
         }
-        input[low] = key;
-        indices[low] = key_index;
-        quick_sort_indice_inverse(input, left, low - 1, indices);
-        quick_sort_indice_inverse(input, low + 1, right, indices);
     }
-    return low;
 }
 
+
 static float sigmoid(float x)
 {
     return 1.0 / (1.0 + expf(-x));
@@ -210,461 +279,517 @@ static float deqnt_affine_u8_to_f32(uint8_t qnt, int32_t zp, float scale)
     return ((float)qnt - (float)zp) * scale;
 }
 
-static void compute_dfl(float *tensor, int dfl_len, float *box)
+// 候选网格扫描: 一次比较 SCAN_BLOCK 个连续网格，只把通过阈值的网格下标写入紧凑列表，
+// 后面的类别/DFL计算只处理这些网格。int8 先异或 0x80 转到无符号域，i8/u8 共用同一套内核
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SCAN_BLOCK 16
+#define SCAN_LANE_BITS 4 // vshrn 得到的掩码每个网格占 4 位
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define SCAN_BLOCK 32
+#define SCAN_LANE_BITS 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SCAN_BLOCK 16
+#define SCAN_LANE_BITS 1
+#endif
+
+#ifdef SCAN_BLOCK
+// 返回 SCAN_BLOCK 个网格的掩码: max(t[c * plane + i] ^ bias) >= thres
+static inline uint64_t scan_block_mask(const uint8_t *t, int plane, int classes, uint8_t bias, uint8_t thres)
 {
-    for (int b = 0; b < 4; b++)
+#if defined(__ARM_NEON)
+    uint8x16_t vbias = vdupq_n_u8(bias);
+    uint8x16_t v = veorq_u8(vld1q_u8(t), vbias);
+    for (int c = 1; c < classes; c++)
     {
-        float exp_t[dfl_len];
-        float exp_sum = 0;
-        float acc_sum = 0;
-        for (int i = 0; i < dfl_len; i++)
+        v = vmaxq_u8(v, veorq_u8(vld1q_u8(t + c * plane), vbias));
+    }
+    uint8x16_t m = vcgeq_u8(v, vdupq_n_u8(thres));
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+#elif defined(__AVX2__)
+    __m256i vbias = _mm256_set1_epi8((char)bias);
+    __m256i v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)t), vbias);
+    for (int c = 1; c < classes; c++)
+    {
+        v = _mm256_max_epu8(v, _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(t + c * plane)), vbias));
+    }
+    __m256i m = _mm256_cmpeq_epi8(_mm256_max_epu8(v, _mm256_set1_epi8((char)thres)), v);
+    return (uint32_t)_mm256_movemask_epi8(m);
+#else
+    __m128i vbias = _mm_set1_epi8((char)bias);
+    __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)t), vbias);
+    for (int c = 1; c < classes; c++)
+    {
+        v = _mm_max_epu8(v, _mm_xor_si128(_mm_loadu_si128((const __m128i *)(t + c * plane)), vbias));
+    }
+    __m128i m = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8((char)thres)), v);
+    return (uint32_t)_mm_movemask_epi8(m);
+#endif
+}
+#endif
+
+// 在 n 个网格中找出 max(t[c * plane + i] ^ bias) >= thres 的网格，返回个数
+static int scan_cells(const uint8_t *t, int plane, int classes, int n, uint8_t bias, uint8_t thres, int *cells)
+{
+    int count = 0;
+    int i = 0;
+#ifdef SCAN_BLOCK
+    const uint64_t lane_mask = (1ULL << SCAN_LANE_BITS) - 1;
+    for (; i + SCAN_BLOCK <= n; i += SCAN_BLOCK)
+    {
+        uint64_t mask = scan_block_mask(t + i, plane, classes, bias, thres);
+        while (mask)
         {
-            exp_t[i] = exp(tensor[i + b * dfl_len]);
-            exp_sum += exp_t[i];
+            int lane = __builtin_ctzll(mask) / SCAN_LANE_BITS;
+            cells[count++] = i + lane;
+            mask &= ~(lane_mask << (lane * SCAN_LANE_BITS));
         }
-
-        for (int i = 0; i < dfl_len; i++)
+    }
+#endif
+    // 标量实现，同时处理不足一个块的尾部
+    for (; i < n; i++)
+    {
+        uint8_t v = t[i] ^ bias;
+        for (int c = 1; c < classes; c++)
         {
-            acc_sum += exp_t[i] / exp_sum * i;
+            uint8_t x = t[c * plane + i] ^ bias;
+            v = x > v ? x : v;
+        }
+        if (v >= thres)
+        {
+            cells[count++] = i;
         }
-        box[b] = acc_sum;
     }
+    return count;
 }
 
-static int process_u8(uint8_t *box_tensor, int32_t box_zp, float box_scale,
-                      uint8_t *score_tensor, int32_t score_zp, float score_scale,
-                      uint8_t *score_sum_tensor, int32_t score_sum_zp, float score_sum_scale,
-                      int grid_h, int grid_w, int stride, int dfl_len,
-                      std::vector<float> &boxes,
-                      std::vector<float> &objProbs,
-                      std::vector<int> &classId,
-                      float threshold)
+// 零拷贝输出在第一次读取前同步 cache，未读取的张量不做同步
+static void *get_output_buf(rknn_app_context_t *app_ctx, void *outputs, int idx)
 {
-    int validCount = 0;
-    int grid_len = grid_h * grid_w;
-    uint8_t score_thres_u8 = qnt_f32_to_affine_u8(threshold, score_zp, score_scale);
-    uint8_t score_sum_thres_u8 = qnt_f32_to_affine_u8(threshold, score_sum_zp, score_sum_scale);
-
-    for (int i = 0; i < grid_h; i++)
+#if defined(RV1106_1103)
+    return ((rknn_tensor_mem **)outputs)[idx]->virt_addr;
+#endif
+    rknn_tensor_mem *mem = app_ctx->npu_output_mems[idx];
+    if (mem != NULL)
     {
-        for (int j = 0; j < grid_w; j++)
-        {
-            int offset = i * grid_w + j;
-            int max_class_id = -1;
+        rknn_mem_sync(app_ctx->rknn_ctx, mem, RKNN_MEMORY_SYNC_FROM_DEVICE);
+        return mem->virt_addr;
+    }
+    return ((rknn_output *)outputs)[idx].buf;
+}
 
-            // Use score sum to quickly filter
-            if (score_sum_tensor != nullptr)
-            {
-                if (score_sum_tensor[offset] < score_sum_thres_u8)
-                {
-                    continue;
-                }
-            }
+// 输出张量布局，NCHW / NHWC / NC1HWC2 统一为:
+// 通道 c 在网格 cell 处的偏移 = (c / c2) * plane + cell * cell_stride + c % c2
+enum
+{
+    LAYOUT_NCHW = 0,    // c2 = 1, 同一通道的网格连续
+    LAYOUT_NHWC = 1,    // 一个网格的所有通道连续
+    LAYOUT_BLOCKED = 2, // NC1HWC2 或各张量布局不一致时的通用寻址
+};
 
-            uint8_t max_score = -score_zp;
-            for (int c = 0; c < OBJ_CLASS_NUM; c++)
-            {
-                if ((score_tensor[offset] > score_thres_u8) && (score_tensor[offset] > max_score))
-                {
-                    max_score = score_tensor[offset];
-                    max_class_id = c;
-                }
-                offset += grid_len;
-            }
+typedef struct
+{
+    int kind;
+    int c2;          // 一个通道块内连续存放的通道数，NCHW 为 1
+    int plane;       // 相邻通道块之间的距离
+    int cell_stride; // 相邻网格之间的距离
+} tensor_layout_t;
+
+// 一个检测分支 (box / score / score_sum) 的输入，张量数据在确认有候选网格后才读取
+typedef struct
+{
+    rknn_app_context_t *app_ctx;
+    void *outputs;
+    int box_idx;
+    int score_idx;
+    int score_sum_idx; // 没有 score_sum 输出时为 -1
+    tensor_layout_t box_layout;
+    tensor_layout_t score_layout;
+    tensor_layout_t score_sum_layout;
+    int grid_h;
+    int grid_w;
+    int stride;
+    int num_class;
+    int dfl_len; // 1 表示直接回归 4 个距离
+    float threshold;
+} branch_t;
+
+// 元素类型相关的操作，量化类型按原始字节查表
+template <typename T>
+struct elem_traits;
+
+template <>
+struct elem_traits<int8_t>
+{
+    static int8_t threshold(float f, int32_t zp, float scale) { return qnt_f32_to_affine(f, zp, scale); }
+    static float value(int8_t v, const qnt_lut_t *lut) { return lut->dequant[(uint8_t)v]; }
+    static float exp_value(int8_t v, const qnt_lut_t *lut) { return lut->exp[(uint8_t)v]; }
+    static bool is_max(int8_t v) { return v == INT8_MAX; }
+    static int scan_ge(const int8_t *t, int plane, int classes, int n, int8_t thres, int *cells)
+    {
+        return scan_cells((const uint8_t *)t, plane, classes, n, 0x80, (uint8_t)thres ^ 0x80, cells);
+    }
+};
 
-            // compute box
-            if (max_score > score_thres_u8)
-            {
-                offset = i * grid_w + j;
-                float box[4];
-                if (dfl_len > 1)
-                {
-                    /// dfl
-                    float before_dfl[dfl_len * 4];
-                    for (int k = 0; k < dfl_len * 4; k++)
-                    {
-                        before_dfl[k] = deqnt_affine_u8_to_f32(box_tensor[offset], box_zp, box_scale);
-                        offset += grid_len;
-                    }
-                    compute_dfl(before_dfl, dfl_len, box);
-                }
-                else
-                {
-                    for (int k = 0; k < 4; k++)
-                    {
-                        box[k] = deqnt_affine_u8_to_f32(box_tensor[offset], box_zp, box_scale);
-                        offset += grid_len;
-                    }
-                }
+template <>
+struct elem_traits<uint8_t>
+{
+    static uint8_t threshold(float f, int32_t zp, float scale) { return qnt_f32_to_affine_u8(f, zp, scale); }
+    static float value(uint8_t v, const qnt_lut_t *lut) { return lut->dequant[v]; }
+    static float exp_value(uint8_t v, const qnt_lut_t *lut) { return lut->exp[v]; }
+    static bool is_max(uint8_t v) { return v == UINT8_MAX; }
+    static int scan_ge(const uint8_t *t, int plane, int classes, int n, uint8_t thres, int *cells)
+    {
+        return scan_cells(t, plane, classes, n, 0, thres, cells);
+    }
+};
 
-                float x1, y1, x2, y2, w, h;
-                x1 = (-box[0] + j + 0.5) * stride;
-                y1 = (-box[1] + i + 0.5) * stride;
-                x2 = (box[2] + j + 0.5) * stride;
-                y2 = (box[3] + i + 0.5) * stride;
-                w = x2 - x1;
-                h = y2 - y1;
-                boxes.push_back(x1);
-                boxes.push_back(y1);
-                boxes.push_back(w);
-                boxes.push_back(h);
-
-                objProbs.push_back(deqnt_affine_u8_to_f32(max_score, score_zp, score_scale));
-                classId.push_back(max_class_id);
-                validCount++;
-            }
+template <>
+struct elem_traits<float>
+{
+    static float threshold(float f, int32_t, float) { return f; }
+    static float value(float v, const qnt_lut_t *) { return v; }
+    static float exp_value(float v, const qnt_lut_t *) { return exp(v); }
+    static bool is_max(float) { return false; }
+    // 浮点没有向量化实现，返回 -1 由调用方逐个网格比较
+    static int scan_ge(const float *, int, int, int, float, int *) { return -1; }
+};
+
+// 取出网格 cell 处连续 n 个通道
+template <typename T, int LAYOUT>
+static inline void load_channels(const T *tensor, const tensor_layout_t *layout, int cell, int n, T *out)
+{
+    if (LAYOUT == LAYOUT_NCHW)
+    {
+        const T *ptr = tensor + cell;
+        for (int c = 0; c < n; c++)
+        {
+            out[c] = ptr[c * layout->plane];
+        }
+    }
+    else if (LAYOUT == LAYOUT_NHWC)
+    {
+        memcpy(out, tensor + cell * layout->cell_stride, n * sizeof(T));
+    }
+    else
+    {
+        const T *ptr = tensor + cell * layout->cell_stride;
+        for (int c = 0; c < n; c += layout->c2)
+        {
+            int len = n - c < layout->c2 ? n - c : layout->c2;
+            memcpy(out + c, ptr, len * sizeof(T));
+            ptr += layout->plane;
         }
     }
-        return validCount;
 }
 
-static int process_i8(int8_t *box_tensor, int32_t box_zp, float box_scale,
-                      int8_t *score_tensor, int32_t score_zp, float score_scale,
-                      int8_t *score_sum_tensor, int32_t score_sum_zp, float score_sum_scale,
-                      int grid_h, int grid_w, int stride, int dfl_len,
-                      std::vector<float> &boxes,
-                      std::vector<float> &objProbs,
-                      std::vector<int> &classId,
-                      float threshold)
+// DFL: 每条边 dfl_len 个分箱做 softmax 后求期望
+template <typename T, int DFL_LEN>
+static inline void compute_dfl(const T *tensor, const qnt_lut_t *lut, int dfl_len_rt, float *box)
 {
-    int validCount = 0;
-    int grid_len = grid_h * grid_w;
-    int8_t score_thres_i8 = qnt_f32_to_affine(threshold, score_zp, score_scale);
-    int8_t score_sum_thres_i8 = qnt_f32_to_affine(threshold, score_sum_zp, score_sum_scale);
-
-    for (int i = 0; i < grid_h; i++)
+    const int dfl_len = DFL_LEN > 0 ? DFL_LEN : dfl_len_rt;
+    for (int b = 0; b < 4; b++)
     {
-        for (int j = 0; j < grid_w; j++)
+        const T *bins = tensor + b * dfl_len;
+        float exp_sum = 0;
+        float acc_sum = 0;
+        for (int i = 0; i < dfl_len; i++)
         {
-            int offset = i * grid_w + j;
-            int max_class_id = -1;
-
-            // 通过 score sum 起到快速过滤的作用
-            if (score_sum_tensor != nullptr)
-            {
-                if (score_sum_tensor[offset] < score_sum_thres_i8)
-                {
-                    continue;
-                }
-            }
-
-            int8_t max_score = -score_zp;
-            for (int c = 0; c < OBJ_CLASS_NUM; c++)
-            {
-                if ((score_tensor[offset] > score_thres_i8) && (score_tensor[offset] > max_score))
-                {
-                    max_score = score_tensor[offset];
-                    max_class_id = c;
-                }
-                offset += grid_len;
-            }
-
-            // compute box
-            if (max_score > score_thres_i8)
-            {
-                offset = i * grid_w + j;
-                float box[4];
-                if (dfl_len > 1)
-                {
-                    /// dfl
-                    float before_dfl[dfl_len * 4];
-                    for (int k = 0; k < dfl_len * 4; k++)
-                    {
-                        before_dfl[k] = deqnt_affine_to_f32(box_tensor[offset], box_zp, box_scale);
-                        offset += grid_len;
-                    }
-                    compute_dfl(before_dfl, dfl_len, box);
-                }
-                else
-                {
-                    for (int k = 0; k < 4; k++)
-                    {
-                        box[k] = deqnt_affine_to_f32(box_tensor[offset], box_zp, box_scale);
-                        offset += grid_len;
-                    }
-                }
-
-                float x1, y1, x2, y2, w, h;
-                x1 = (-box[0] + j + 0.5) * stride;
-                y1 = (-box[1] + i + 0.5) * stride;
-                x2 = (box[2] + j + 0.5) * stride;
-                y2 = (box[3] + i + 0.5) * stride;
-                w = x2 - x1;
-                h = y2 - y1;
-                boxes.push_back(x1);
-                boxes.push_back(y1);
-                boxes.push_back(w);
-                boxes.push_back(h);
-
-                objProbs.push_back(deqnt_affine_to_f32(max_score, score_zp, score_scale));
-                classId.push_back(max_class_id);
-                validCount++;
-            }
+            float e = elem_traits<T>::exp_value(bins[i], lut);
+            exp_sum += e;
+            acc_sum += e * i;
         }
+        box[b] = acc_sum / exp_sum;
     }
-        return validCount;
 }
 
-static int process_fp32(float *box_tensor, float *score_tensor, float *score_sum_tensor,
-                        int grid_h, int grid_w, int stride, int dfl_len,
-                        std::vector<float> &boxes,
-                        std::vector<float> &objProbs,
-                        std::vector<int> &classId,
-                        float threshold)
+// 找出可能有目标的网格: 有 score_sum 时取 score_sum >= 阈值的网格，
+// 否则取任一类别分数 > 阈值的网格，无法预筛时返回全部网格
+template <typename T>
+static int scan_candidates(const branch_t *br, const T *score_sum, T score_sum_thres,
+                           const T *score, T score_thres, int *cells)
 {
-    int validCount = 0;
-    int grid_len = grid_h * grid_w;
-    for (int i = 0; i < grid_h; i++)
+    int grid_len = br->grid_h * br->grid_w;
+    int n_cells = -1;
+    if (score_sum != nullptr)
     {
-        for (int j = 0; j < grid_w; j++)
+        int cell_stride = br->score_sum_layout.cell_stride;
+        if (cell_stride == 1)
         {
-            int offset = i * grid_w + j;
-            int max_class_id = -1;
-
-            // 通过 score sum 起到快速过滤的作用
-            if (score_sum_tensor != nullptr)
-            {
-                if (score_sum_tensor[offset] < threshold)
-                {
-                    continue;
-                }
-            }
-
-            float max_score = 0;
-            for (int c = 0; c < OBJ_CLASS_NUM; c++)
+            n_cells = elem_traits<T>::scan_ge(score_sum, 0, 1, grid_len, score_sum_thres, cells);
+        }
+        if (n_cells < 0)
+        {
+            // 原生布局下 score_sum 不连续，逐个网格比较
+            n_cells = 0;
+            for (int k = 0; k < grid_len; k++)
             {
-                if ((score_tensor[offset] > threshold) && (score_tensor[offset] > max_score))
+                if (score_sum[k * cell_stride] >= score_sum_thres)
                 {
-                    max_score = score_tensor[offset];
-                    max_class_id = c;
+                    cells[n_cells++] = k;
                 }
-                offset += grid_len;
             }
+        }
+        return n_cells;
+    }
 
-            // compute box
-            if (max_score > threshold)
-            {
-                offset = i * grid_w + j;
-                float box[4];
-                if (dfl_len > 1)
-                {
-                    /// dfl
-                    float before_dfl[dfl_len * 4];
-                    for (int k = 0; k < dfl_len * 4; k++)
-                    {
-                        before_dfl[k] = box_tensor[offset];
-                        offset += grid_len;
-                    }
-                    compute_dfl(before_dfl, dfl_len, box);
-                }
-                else
-                {
-                    for (int k = 0; k < 4; k++)
-                    {
-                        box[k] = box_tensor[offset];
-                        offset += grid_len;
-                    }
-                }
-
-                float x1, y1, x2, y2, w, h;
-                x1 = (-box[0] + j + 0.5) * stride;
-                y1 = (-box[1] + i + 0.5) * stride;
-                x2 = (box[2] + j + 0.5) * stride;
-                y2 = (box[3] + i + 0.5) * stride;
-                w = x2 - x1;
-                h = y2 - y1;
-                boxes.push_back(x1);
-                boxes.push_back(y1);
-                boxes.push_back(w);
-                boxes.push_back(h);
-
-                objProbs.push_back(max_score);
-                classId.push_back(max_class_id);
-                validCount++;
-            }
+    if (elem_traits<T>::is_max(score_thres))
+    {
+        return 0;
+    }
+    if (br->score_layout.kind == LAYOUT_NCHW)
+    {
+        n_cells = elem_traits<T>::scan_ge(score, br->score_layout.plane, br->num_class, grid_len, score_thres + 1, cells);
+    }
+    if (n_cells < 0)
+    {
+        n_cells = grid_len;
+        for (int k = 0; k < grid_len; k++)
+        {
+            cells[k] = k;
         }
     }
-        return validCount;
+    return n_cells;
 }
 
-#if defined(RV1106_1103)
-static int process_i8_rv1106(int8_t *box_tensor, int32_t box_zp, float box_scale,
-                             int8_t *score_tensor, int32_t score_zp, float score_scale,
-                             int8_t *score_sum_tensor, int32_t score_sum_zp, float score_sum_scale,
-                             int grid_h, int grid_w, int stride, int dfl_len,
-                             std::vector<float> &boxes,
-                             std::vector<float> &objProbs,
-                             std::vector<int> &classId,
-                             float threshold)
+// 单个分支的候选框提取。NUM_CLASS / DFL_LEN 为 0 时使用运行时的值，
+// 非 0 时内层循环次数固定，编译器可以展开和向量化
+template <typename T, int LAYOUT, int NUM_CLASS, int DFL_LEN>
+static int process_branch(const branch_t *br, post_process_buf_t *buf, int validCount)
 {
-    int validCount = 0;
-    int grid_len = grid_h * grid_w;
-    int8_t score_thres_i8 = qnt_f32_to_affine(threshold, score_zp, score_scale);
-    int8_t score_sum_thres_i8 = qnt_f32_to_affine(threshold, score_sum_zp, score_sum_scale);
+    rknn_app_context_t *app_ctx = br->app_ctx;
+    const rknn_tensor_attr *score_attr = &app_ctx->output_attrs[br->score_idx];
+    const qnt_lut_t *box_lut = app_ctx->is_quant ? &app_ctx->output_luts[br->box_idx] : nullptr;
+    const qnt_lut_t *score_lut = app_ctx->is_quant ? &app_ctx->output_luts[br->score_idx] : nullptr;
+    const int num_class = NUM_CLASS > 0 ? NUM_CLASS : br->num_class;
+    const int dfl_len = DFL_LEN > 0 ? DFL_LEN : br->dfl_len;
+    const int box_len = dfl_len > 1 ? dfl_len * 4 : 4;
+    T score_thres = elem_traits<T>::threshold(br->threshold, score_attr->zp, score_attr->scale);
+    T score_sum_thres = score_thres;
+    const T *score_sum = nullptr;
+    const T *score = nullptr;
+    if (br->score_sum_idx >= 0)
+    {
+        const rknn_tensor_attr *attr = &app_ctx->output_attrs[br->score_sum_idx];
+        score_sum_thres = elem_traits<T>::threshold(br->threshold, attr->zp, attr->scale);
+        score_sum = (const T *)get_output_buf(app_ctx, br->outputs, br->score_sum_idx);
+    }
+    else
+    {
+        score = (const T *)get_output_buf(app_ctx, br->outputs, br->score_idx);
+    }
 
-    for (int i = 0; i < grid_h; i++)
+    int *cells = buf->cells;
+    int n_cells = scan_candidates<T>(br, score_sum, score_sum_thres, score, score_thres, cells);
+    // 没有候选网格时直接返回，零拷贝输出也就不用同步 box/score 张量
+    if (n_cells == 0)
     {
-        for (int j = 0; j < grid_w; j++)
-        {
-            int offset = i * grid_w + j;
-            int max_class_id = -1;
+        return validCount;
+    }
+    if (score == nullptr)
+    {
+        score = (const T *)get_output_buf(app_ctx, br->outputs, br->score_idx);
+    }
+    const T *box_tensor = (const T *)get_output_buf(app_ctx, br->outputs, br->box_idx);
 
-            // 通过 score sum 起到快速过滤的作用
-            if (score_sum_tensor != nullptr)
+    T scores[num_class];
+    T box_raw[box_len];
+    for (int n = 0; n < n_cells; n++)
+    {
+        int offset = cells[n];
+        int i = offset / br->grid_w;
+        int j = offset % br->grid_w;
+
+        load_channels<T, LAYOUT>(score, &br->score_layout, offset, num_class, scores);
+        int max_class_id = -1;
+        T max_score = score_thres;
+        for (int c = 0; c < num_class; c++)
+        {
+            if (scores[c] > max_score)
             {
-                // score_sum_tensor [1, 1, 80, 80]
-                if (score_sum_tensor[offset] < score_sum_thres_i8)
-                {
-                    continue;
-                }
+                max_score = scores[c];
+                max_class_id = c;
             }
+        }
+        if (max_class_id < 0)
+        {
+            continue;
+        }
 
-            int8_t max_score = -score_zp;
-            offset = offset * OBJ_CLASS_NUM;
-            for (int c = 0; c < OBJ_CLASS_NUM; c++)
+        // compute box
+        load_channels<T, LAYOUT>(box_tensor, &br->box_layout, offset, box_len, box_raw);
+        float box[4];
+        if (dfl_len > 1)
+        {
+            compute_dfl<T, DFL_LEN>(box_raw, box_lut, dfl_len, box);
+        }
+        else
+        {
+            for (int k = 0; k < 4; k++)
             {
-                if ((score_tensor[offset + c] > score_thres_i8) && (score_tensor[offset + c] > max_score))
-                {
-                    max_score = score_tensor[offset + c]; // 80类 [1, 80, 80, 80] 3588NCHW 1106NHWC
-                    max_class_id = c;
-                }
+                box[k] = elem_traits<T>::value(box_raw[k], box_lut);
             }
+        }
 
-            // compute box
-            if (max_score > score_thres_i8)
-            {
-                offset = (i * grid_w + j) * 4;
-                float box[4];
-                for (int k = 0; k < 4; k++)
-                {
-                    box[k] = deqnt_affine_to_f32(box_tensor[offset + k], box_zp, box_scale);
-                }
+        buf->x1[validCount] = (-box[0] + j + 0.5) * br->stride;
+        buf->y1[validCount] = (-box[1] + i + 0.5) * br->stride;
+        buf->x2[validCount] = (box[2] + j + 0.5) * br->stride;
+        buf->y2[validCount] = (box[3] + i + 0.5) * br->stride;
+        buf->score[validCount] = elem_traits<T>::value(max_score, score_lut);
+        buf->cls[validCount] = max_class_id;
+        validCount++;
+    }
+    return validCount;
+}
 
-                float x1, y1, x2, y2, w, h;
-                x1 = (-box[0] + j + 0.5) * stride;
-                y1 = (-box[1] + i + 0.5) * stride;
-                x2 = (box[2] + j + 0.5) * stride;
-                y2 = (box[3] + i + 0.5) * stride;
-                w = x2 - x1;
-                h = y2 - y1;
-                boxes.push_back(x1);
-                boxes.push_back(y1);
-                boxes.push_back(w);
-                boxes.push_back(h);
-
-                objProbs.push_back(deqnt_affine_to_f32(max_score, score_zp, score_scale));
-                classId.push_back(max_class_id);
-                validCount++;
-            }
-        }
+// 常用的类别数 / DFL 长度组合使用特化版本，其余走运行时版本
+template <typename T, int LAYOUT>
+static int process_branch_layout(const branch_t *br, post_process_buf_t *buf, int validCount)
+{
+    if (br->num_class == OBJ_CLASS_NUM && br->dfl_len == 16)
+    {
+        return process_branch<T, LAYOUT, OBJ_CLASS_NUM, 16>(br, buf, validCount);
     }
-        return validCount;
+    if (br->num_class == OBJ_CLASS_NUM && br->dfl_len == 1)
+    {
+        return process_branch<T, LAYOUT, OBJ_CLASS_NUM, 1>(br, buf, validCount);
+    }
+    if (br->num_class == 80 && br->dfl_len == 16)
+    {
+        return process_branch<T, LAYOUT, 80, 16>(br, buf, validCount);
+    }
+    if (br->num_class == 80 && br->dfl_len == 1)
+    {
+        return process_branch<T, LAYOUT, 80, 1>(br, buf, validCount);
+    }
+    return process_branch<T, LAYOUT, 0, 0>(br, buf, validCount);
 }
-#endif
 
-int post_process(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter_box, float conf_threshold, float nms_threshold, object_detect_result_list *od_results)
+template <typename T>
+static int process_branch_type(const branch_t *br, post_process_buf_t *buf, int validCount)
 {
-#if defined(RV1106_1103)
-    rknn_tensor_mem **_outputs = (rknn_tensor_mem **)outputs;
+    int kind = br->box_layout.kind == br->score_layout.kind ? br->box_layout.kind : LAYOUT_BLOCKED;
+    switch (kind)
+    {
+    case LAYOUT_NCHW:
+        return process_branch_layout<T, LAYOUT_NCHW>(br, buf, validCount);
+    case LAYOUT_NHWC:
+        return process_branch_layout<T, LAYOUT_NHWC>(br, buf, validCount);
+    default:
+        return process_branch_layout<T, LAYOUT_BLOCKED>(br, buf, validCount);
+    }
+}
+
+// 张量逻辑形状 (通道数、网格高、网格宽)
+static void get_tensor_shape(const rknn_tensor_attr *attr, int *c, int *h, int *w)
+{
+#ifdef RKNPU1
+    // NCHW reversed: WHCN
+    *c = attr->dims[2];
+    *h = attr->dims[1];
+    *w = attr->dims[0];
 #else
-    rknn_output *_outputs = (rknn_output *)outputs;
+    if (attr->fmt == RKNN_TENSOR_NHWC)
+    {
+        *h = attr->dims[1];
+        *w = attr->dims[2];
+        *c = attr->dims[3];
+    }
+    else
+    {
+        *c = attr->dims[1];
+        *h = attr->dims[2];
+        *w = attr->dims[3];
+    }
+#endif
+}
+
+// 零拷贝输出按绑定时的原生布局读取，否则按输出属性的逻辑布局
+static void get_output_layout(rknn_app_context_t *app_ctx, int idx, int grid_len, tensor_layout_t *layout)
+{
+    const rknn_tensor_attr *attr = &app_ctx->output_attrs[idx];
+#ifndef RKNPU1
+    if (app_ctx->npu_output_mems[idx] != NULL)
+    {
+        attr = &app_ctx->npu_output_attrs[idx];
+    }
+#endif
+    layout->kind = LAYOUT_NCHW;
+    layout->c2 = 1;
+    layout->plane = grid_len;
+    layout->cell_stride = 1;
+#ifndef RKNPU1
+    if (attr->fmt == RKNN_TENSOR_NHWC)
+    {
+        layout->kind = LAYOUT_NHWC;
+        layout->c2 = attr->dims[3];
+        layout->cell_stride = attr->dims[3];
+        layout->plane = grid_len * attr->dims[3];
+    }
+    else if (attr->fmt == RKNN_TENSOR_NC1HWC2)
+    {
+        layout->kind = LAYOUT_BLOCKED;
+        layout->c2 = attr->dims[4];
+        layout->cell_stride = attr->dims[4];
+        layout->plane = grid_len * attr->dims[4];
+    }
 #endif
-    std::vector<float> filterBoxes;
-    std::vector<float> objProbs;
-    std::vector<int> classId;
+}
+
+int post_process(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter_box, float conf_threshold, float nms_threshold, object_detect_result_list *od_results)
+{
+    post_process_buf_t *buf = app_ctx->post_buf;
     int validCount = 0;
-    int stride = 0;
-    int grid_h = 0;
-    int grid_w = 0;
     int model_in_w = app_ctx->model_width;
     int model_in_h = app_ctx->model_height;
 
     memset(od_results, 0, sizeof(object_detect_result_list));
+    if (buf == NULL)
+    {
+        printf("后处理缓冲区未初始化\n");
+        return -1;
+    }
 
     // default 3 branch
-#ifdef RKNPU1
-    // NCHW reversed: WHCN
-    int dfl_len = app_ctx->output_attrs[0].dims[2] / 4;
-#else
-    int dfl_len = app_ctx->output_attrs[0].dims[1] / 4;
-#endif
     int output_per_branch = app_ctx->io_num.n_output / 3;
     for (int i = 0; i < 3; i++)
     {
-#if defined(RV1106_1103)
-        void *score_sum = nullptr;
-        int32_t score_sum_zp = 0;
-        float score_sum_scale = 1.0;
-        if (output_per_branch == 3)
+        branch_t br;
+        int box_c, num_class;
+        br.app_ctx = app_ctx;
+        br.outputs = outputs;
+        br.box_idx = i * output_per_branch;
+        br.score_idx = i * output_per_branch + 1;
+        br.score_sum_idx = output_per_branch == 3 ? i * output_per_branch + 2 : -1;
+        get_tensor_shape(&app_ctx->output_attrs[br.box_idx], &box_c, &br.grid_h, &br.grid_w);
+        get_tensor_shape(&app_ctx->output_attrs[br.score_idx], &num_class, &br.grid_h, &br.grid_w);
+        br.num_class = num_class;
+        br.dfl_len = box_c >= 8 ? box_c / 4 : 1;
+        br.stride = model_in_h / br.grid_h;
+        br.threshold = conf_threshold;
+
+        int grid_len = br.grid_h * br.grid_w;
+        get_output_layout(app_ctx, br.box_idx, grid_len, &br.box_layout);
+        get_output_layout(app_ctx, br.score_idx, grid_len, &br.score_layout);
+        if (br.score_sum_idx >= 0)
         {
-            score_sum = _outputs[i * output_per_branch + 2]->virt_addr;
-            score_sum_zp = app_ctx->output_attrs[i * output_per_branch + 2].zp;
-            score_sum_scale = app_ctx->output_attrs[i * output_per_branch + 2].scale;
+            get_output_layout(app_ctx, br.score_sum_idx, grid_len, &br.score_sum_layout);
         }
-        int box_idx = i * output_per_branch;
-        int score_idx = i * output_per_branch + 1;
-        grid_h = app_ctx->output_attrs[box_idx].dims[1];
-        grid_w = app_ctx->output_attrs[box_idx].dims[2];
-        stride = model_in_h / grid_h;
 
-        if (app_ctx->is_quant)
-        {
-            validCount += process_i8_rv1106((int8_t *)_outputs[box_idx]->virt_addr, app_ctx->output_attrs[box_idx].zp, app_ctx->output_attrs[box_idx].scale,
-                                            (int8_t *)_outputs[score_idx]->virt_addr, app_ctx->output_attrs[score_idx].zp,
-                                            app_ctx->output_attrs[score_idx].scale, (int8_t *)score_sum, score_sum_zp, score_sum_scale,
-                                            grid_h, grid_w, stride, dfl_len, filterBoxes, objProbs, classId, conf_threshold);
-        }
-        else
-        {
-                        return -1;
-        }
-
-#else
-        void *score_sum = nullptr;
-        int32_t score_sum_zp = 0;
-        float score_sum_scale = 1.0;
-        if (output_per_branch == 3)
+        if (!app_ctx->is_quant)
         {
-            score_sum = _outputs[i * output_per_branch + 2].buf;
-            score_sum_zp = app_ctx->output_attrs[i * output_per_branch + 2].zp;
-            score_sum_scale = app_ctx->output_attrs[i * output_per_branch + 2].scale;
+            validCount = process_branch_type<float>(&br, buf, validCount);
         }
-        int box_idx = i * output_per_branch;
-        int score_idx = i * output_per_branch + 1;
-
-#ifdef RKNPU1
-        // NCHW reversed: WHCN
-        grid_h = app_ctx->output_attrs[box_idx].dims[1];
-        grid_w = app_ctx->output_attrs[box_idx].dims[0];
-#else
-        grid_h = app_ctx->output_attrs[box_idx].dims[2];
-        grid_w = app_ctx->output_attrs[box_idx].dims[3];
-#endif
-        stride = model_in_h / grid_h;
-
-        if (app_ctx->is_quant)
+        else if (app_ctx->output_attrs[br.score_idx].type == RKNN_TENSOR_UINT8)
         {
-#ifdef RKNPU1
-            validCount += process_u8((uint8_t *)_outputs[box_idx].buf, app_ctx->output_attrs[box_idx].zp, app_ctx->output_attrs[box_idx].scale,
-                                     (uint8_t *)_outputs[score_idx].buf, app_ctx->output_attrs[score_idx].zp, app_ctx->output_attrs[score_idx].scale,
-                                     (uint8_t *)score_sum, score_sum_zp, score_sum_scale,
-                                     grid_h, grid_w, stride, dfl_len,
-                                     filterBoxes, objProbs, classId, conf_threshold);
-#else
-            validCount += process_i8((int8_t *)_outputs[box_idx].buf, app_ctx->output_attrs[box_idx].zp, app_ctx->output_attrs[box_idx].scale,
-                                     (int8_t *)_outputs[score_idx].buf, app_ctx->output_attrs[score_idx].zp, app_ctx->output_attrs[score_idx].scale,
-                                     (int8_t *)score_sum, score_sum_zp, score_sum_scale,
-                                     grid_h, grid_w, stride, dfl_len,
-                                     filterBoxes, objProbs, classId, conf_threshold);
-#endif
+            validCount = process_branch_type<uint8_t>(&br, buf, validCount);
         }
         else
         {
-            validCount += process_fp32((float *)_outputs[box_idx].buf, (float *)_outputs[score_idx].buf, (float *)score_sum,
-                                       grid_h, grid_w, stride, dfl_len,
-                                       filterBoxes, objProbs, classId, conf_threshold);
+            validCount = process_branch_type<int8_t>(&br, buf, validCount);
         }
-#endif
     }
 
     // no object detect
@@ -672,37 +797,26 @@ int post_process(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter
     {
         return 0;
     }
-    std::vector<int> indexArray;
-    for (int i = 0; i < validCount; ++i)
-    {
-        indexArray.push_back(i);
-    }
-    quick_sort_indice_inverse(objProbs, 0, validCount - 1, indexArray);
-
-    std::set<int> class_set(std::begin(classId), std::end(classId));
-
-    for (auto c : class_set)
-    {
-        nms(validCount, filterBoxes, classId, indexArray, c, nms_threshold);
-    }
+    int candidates = select_top_candidates(buf, validCount, NMS_MAX_CANDIDATES);
+    nms_by_class(buf, validCount, candidates, nms_threshold);
 
     int last_count = 0;
     od_results->count = 0;
 
     /* box valid detect target */
-    for (int i = 0; i < validCount; ++i)
+    for (int i = 0; i < candidates; ++i)
     {
-        if (indexArray[i] == -1 || last_count >= OBJ_NUMB_MAX_SIZE)
+        int n = buf->order[i];
+        if (!buf->keep[n] || last_count >= OBJ_NUMB_MAX_SIZE)
         {
             continue;
         }
-        int n = indexArray[i];
 
         // 先从模型输出坐标转换到预处理图像坐标（减去padding）
-        float x1 = filterBoxes[n * 4 + 0] - letter_box->x_pad;
-        float y1 = filterBoxes[n * 4 + 1] - letter_box->y_pad;
-        float x2 = x1 + filterBoxes[n * 4 + 2];
-        float y2 = y1 + filterBoxes[n * 4 + 3];
+        float x1 = buf->x1[n] - letter_box->x_pad;
+        float y1 = buf->y1[n] - letter_box->y_pad;
+        float x2 = buf->x2[n] - letter_box->x_pad;
+        float y2 = buf->y2[n] - letter_box->y_pad;
 
         // 限制在预处理图像的有效区域内
         float letterbox_img_w = model_in_w - letter_box->x_pad * 2;
@@ -712,8 +826,8 @@ int post_process(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter
         x2 = clampf(x2, 0, letterbox_img_w);
         y2 = clampf(y2, 0, letterbox_img_h);
 
-        int id = classId[n];
-        float obj_conf = objProbs[i];
+        int id = buf->cls[n];
+        float obj_conf = buf->score[n];
 
         // 再从预处理图像坐标转换回原始图像坐标（除以scale）
         od_results->results[last_count].box.left = (int)(x1 / letter_box->scale);
@@ -728,6 +842,106 @@ int post_process(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter
     return 0;
 }
 
+// 按模型所有分支的网格总数和最大类别数分配，之后每帧复用
+int init_post_process_buf(rknn_app_context_t *app_ctx)
+{
+    int output_per_branch = app_ctx->io_num.n_output / 3;
+    int capacity = 0;
+    int num_class = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        int c, h, w;
+        get_tensor_shape(&app_ctx->output_attrs[i * output_per_branch + 1], &c, &h, &w);
+        capacity += h * w;
+        num_class = c > num_class ? c : num_class;
+    }
+
+    release_post_process_buf(app_ctx);
+    post_process_buf_t *buf = (post_process_buf_t *)calloc(1, sizeof(post_process_buf_t));
+    if (buf == NULL)
+    {
+        return -1;
+    }
+    buf->capacity = capacity;
+    buf->num_class = num_class;
+    buf->grid_w = (app_ctx->model_width + NMS_GRID_CELL - 1) / NMS_GRID_CELL;
+    buf->grid_h = (app_ctx->model_height + NMS_GRID_CELL - 1) / NMS_GRID_CELL;
+    buf->x1 = (float *)malloc(capacity * sizeof(float));
+    buf->y1 = (float *)malloc(capacity * sizeof(float));
+    buf->x2 = (float *)malloc(capacity * sizeof(float));
+    buf->y2 = (float *)malloc(capacity * sizeof(float));
+    buf->score = (float *)malloc(capacity * sizeof(float));
+    buf->cls = (int *)malloc(capacity * sizeof(int));
+    buf->cells = (int *)malloc(capacity * sizeof(int));
+    buf->order = (int *)malloc(capacity * sizeof(int));
+    buf->bucketed = (int *)malloc(capacity * sizeof(int));
+    buf->kept = (int *)malloc(capacity * sizeof(int));
+    buf->grid_next = (int *)malloc(capacity * sizeof(int));
+    buf->keep = (char *)malloc(capacity * sizeof(char));
+    buf->bucket_start = (int *)malloc((num_class + 1) * sizeof(int));
+    buf->bucket_fill = (int *)malloc((num_class + 1) * sizeof(int));
+    buf->grid_head = (int *)malloc(buf->grid_w * buf->grid_h * sizeof(int));
+    app_ctx->post_buf = buf;
+    if (!buf->x1 || !buf->y1 || !buf->x2 || !buf->y2 || !buf->score || !buf->cls || !buf->cells || !buf->order ||
+        !buf->bucketed || !buf->kept || !buf->grid_next || !buf->keep || !buf->bucket_start || !buf->bucket_fill ||
+        !buf->grid_head)
+    {
+        release_post_process_buf(app_ctx);
+        return -1;
+    }
+    return 0;
+}
+
+void release_post_process_buf(rknn_app_context_t *app_ctx)
+{
+    post_process_buf_t *buf = app_ctx->post_buf;
+    if (buf == NULL)
+    {
+        return;
+    }
+    free(buf->x1);
+    free(buf->y1);
+    free(buf->x2);
+    free(buf->y2);
+    free(buf->score);
+    free(buf->cls);
+    free(buf->cells);
+    free(buf->order);
+    free(buf->bucketed);
+    free(buf->kept);
+    free(buf->grid_next);
+    free(buf->keep);
+    free(buf->bucket_start);
+    free(buf->bucket_fill);
+    free(buf->grid_head);
+    free(buf);
+    app_ctx->post_buf = NULL;
+}
+
+int init_qnt_luts(rknn_app_context_t *app_ctx)
+{
+    int n_output = app_ctx->io_num.n_output;
+    qnt_lut_t *luts = (qnt_lut_t *)malloc(n_output * sizeof(qnt_lut_t));
+    if (luts == NULL)
+    {
+        return -1;
+    }
+    for (int i = 0; i < n_output; i++)
+    {
+        const rknn_tensor_attr *attr = &app_ctx->output_attrs[i];
+        for (int b = 0; b < 256; b++)
+        {
+            float v = attr->type == RKNN_TENSOR_UINT8 ? deqnt_affine_u8_to_f32((uint8_t)b, attr->zp, attr->scale)
+                                                      : deqnt_affine_to_f32((int8_t)b, attr->zp, attr->scale);
+            luts[i].dequant[b] = v;
+            luts[i].exp[b] = exp(v);
+        }
+    }
+    free(app_ctx->output_luts);
+    app_ctx->output_luts = luts;
+    return 0;
+}
+
 int init_post_process()
 {
     int ret = 0;
@@ -742,7 +956,7 @@ int init_post_process()
 char *coco_cls_to_name(int cls_id)
 {
 
-    if (cls_id >= OBJ_CLASS_NUM)
+    if (cls_id < 0 || cls_id >= OBJ_CLASS_MAX)
     {
         return "null";
     }
@@ -757,7 +971,7 @@ char *coco_cls_to_name(int cls_id)
 
 void deinit_post_process()
 {
-    for (int i = 0; i < OBJ_CLASS_NUM; i++)
+    for (int i = 0; i < OBJ_CLASS_MAX; i++)
     {
         if (labels[i] != nullptr)
         {
@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "result_sink.h"
+
+int parse_result_sink_format(const char *name, const char *path)
+{
+    if (name == NULL && path != NULL)
+    {
+        name = strrchr(path, '.');
+        name = name != NULL ? name + 1 : "jsonl";
+    }
+    if (name == NULL)
+    {
+        return -1;
+    }
+    if (strcasecmp(name, "jsonl") == 0 || strcasecmp(name, "json") == 0)
+    {
+        return RESULT_SINK_JSONL;
+    }
+    if (strcasecmp(name, "csv") == 0)
+    {
+        return RESULT_SINK_CSV;
+    }
+    if (strcasecmp(name, "bin") == 0 || strcasecmp(name, "binary") == 0)
+    {
+        return RESULT_SINK_BINARY;
+    }
+    return -1;
+}
+
+int open_result_sink(const char *path, int format, result_sink_t *sink)
+{
+    memset(sink, 0, sizeof(result_sink_t));
+    if (format < RESULT_SINK_JSONL || format > RESULT_SINK_BINARY)
+    {
+        printf("不支持的结果格式: %d\n", format);
+        return -1;
+    }
+
+    sink->fp = fopen(path, format == RESULT_SINK_BINARY ? "wb" : "w");
+    if (sink->fp == NULL)
+    {
+        printf("无法创建结果文件: %s\n", path);
+        return -1;
+    }
+    sink->format = format;
+
+    if (format == RESULT_SINK_CSV)
+    {
+        fprintf(sink->fp, "image_id,path,width,height,status,cls_id,class,prop,left,top,right,bottom\n");
+    }
+    else if (format == RESULT_SINK_BINARY)
+    {
+        result_file_header_t header;
+        memset(&header, 0, sizeof(header));
+        header.magic = RESULT_BINARY_MAGIC;
+        header.version = RESULT_BINARY_VERSION;
+        header.record_size = sizeof(object_detect_result);
+        fwrite(&header, sizeof(header), 1, sink->fp);
+    }
+    return 0;
+}
+
+// JSON 字符串转义，路径里可能有引号、反斜杠和控制字符
+static void write_json_string(FILE *fp, const char *str)
+{
+    fputc('"', fp);
+    for (const unsigned char *p = (const unsigned char *)str; *p != '\0'; p++)
+    {
+        if (*p == '"' || *p == '\\')
+        {
+            fputc('\\', fp);
+            fputc(*p, fp);
+        }
+        else if (*p < 0x20)
+        {
+            fprintf(fp, "\\u%04x", *p);
+        }
+        else
+        {
+            fputc(*p, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+static void write_csv_string(FILE *fp, const char *str)
+{
+    if (strpbrk(str, ",\"\r\n") == NULL)
+    {
+        fputs(str, fp);
+        return;
+    }
+    fputc('"', fp);
+    for (const char *p = str; *p != '\0'; p++)
+    {
+        if (*p == '"')
+        {
+            fputc('"', fp);
+        }
+        fputc(*p, fp);
+    }
+    fputc('"', fp);
+}
+
+static void write_jsonl(FILE *fp, long image_id, const char *image_path, int width, int height,
+                        const object_detect_result_list *od_results)
+{
+    fprintf(fp, "{\"image_id\":%ld,\"path\":", image_id);
+    write_json_string(fp, image_path);
+    if (od_results == NULL)
+    {
+        fprintf(fp, ",\"status\":\"failed\"}\n");
+        return;
+    }
+    fprintf(fp, ",\"width\":%d,\"height\":%d,\"status\":\"ok\",\"objects\":[", width, height);
+    for (int i = 0; i < od_results->count; i++)
+    {
+        const object_detect_result *det = &od_results->results[i];
+        fprintf(fp, "%s{\"cls_id\":%d,\"class\":", i > 0 ? "," : "", det->cls_id);
+        write_json_string(fp, coco_cls_to_name(det->cls_id));
+        fprintf(fp, ",\"prop\":%.4f,\"box\":[%d,%d,%d,%d]}", det->prop,
+                det->box.left, det->box.top, det->box.right, det->box.bottom);
+    }
+    fprintf(fp, "]}\n");
+}
+
+static void write_csv(FILE *fp, long image_id, const char *image_path, int width, int height,
+                      const object_detect_result_list *od_results)
+{
+    int count = od_results != NULL ? od_results->count : 0;
+    int rows = count > 0 ? count : 1;
+    for (int i = 0; i < rows; i++)
+    {
+        fprintf(fp, "%ld,", image_id);
+        write_csv_string(fp, image_path);
+        if (od_results == NULL)
+        {
+            fprintf(fp, ",,,failed,,,,,,,\n");
+            continue;
+        }
+        fprintf(fp, ",%d,%d,ok,", width, height);
+        if (count == 0)
+        {
+            fprintf(fp, ",,,,,,\n");
+            continue;
+        }
+        const object_detect_result *det = &od_results->results[i];
+        fprintf(fp, "%d,", det->cls_id);
+        write_csv_string(fp, coco_cls_to_name(det->cls_id));
+        fprintf(fp, ",%.4f,%d,%d,%d,%d\n", det->prop,
+                det->box.left, det->box.top, det->box.right, det->box.bottom);
+    }
+}
+
+static void write_binary(FILE *fp, long image_id, int width, int height, const object_detect_result_list *od_results)
+{
+    result_record_header_t record;
+    memset(&record, 0, sizeof(record));
+    record.image_id = image_id;
+    record.width = width;
+    record.height = height;
+    record.count = od_results != NULL ? od_results->count : -1;
+    fwrite(&record, sizeof(record), 1, fp);
+    if (record.count > 0)
+    {
+        fwrite(od_results->results, sizeof(object_detect_result), record.count, fp);
+    }
+}
+
+int result_sink_write(result_sink_t *sink, long image_id, const char *image_path, int width, int height,
+                      const object_detect_result_list *od_results)
+{
+    if (sink == NULL || sink->fp == NULL)
+    {
+        return -1;
+    }
+    switch (sink->format)
+    {
+    case RESULT_SINK_JSONL:
+        write_jsonl(sink->fp, image_id, image_path, width, height, od_results);
+        break;
+    case RESULT_SINK_CSV:
+        write_csv(sink->fp, image_id, image_path, width, height, od_results);
+        break;
+    case RESULT_SINK_BINARY:
+        write_binary(sink->fp, image_id, width, height, od_results);
+        break;
+    default:
+        return -1;
+    }
+    sink->count++;
+    return ferror(sink->fp) ? -1 : 0;
+}
+
+int close_result_sink(result_sink_t *sink)
+{
+    if (sink == NULL || sink->fp == NULL)
+    {
+        return 0;
+    }
+    int ret = fclose(sink->fp);
+    sink->fp = NULL;
+    if (ret != 0)
+    {
+        printf("结果文件写入失败\n");
+        return -1;
+    }
+    return 0;
+}
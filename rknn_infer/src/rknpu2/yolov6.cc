@@ -21,6 +21,7 @@
 #include "common.h"
 #include "file_utils.h"
 #include "image_utils.h"
+#include "image_buffer_pool.h"
 #include "yolov6.h"
 
 
@@ -31,45 +32,9 @@ static long long get_current_time_ms()
     return (long long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
 }
 
-int init_yolov6_model(const char *model_path, rknn_app_context_t *app_ctx)
+static int query_yolov6_model_info(rknn_context ctx, rknn_app_context_t *app_ctx)
 {
     int ret;
-    int model_len = 0;
-    char *model;
-    rknn_context ctx = 0;
-
-    printf("开始初始化YOLOv6模型...\n");
-    printf("模型路径: %s\n", model_path);
-
-    // Load RKNN Model
-    printf("正在加载RKNN模型文件...\n");
-    model_len = read_data_from_file(model_path, &model);
-    if (model == NULL)
-    {
-        printf("模型文件加载失败!\n");
-        return -1;
-    }
-    printf("模型文件加载成功，大小: %d bytes\n", model_len);
-
-    printf("正在初始化RKNN上下文...\n");
-    ret = rknn_init(&ctx, model, model_len, RKNN_NPU_CORE_0_1_2, NULL);
-    free(model);
-    if (ret < 0)
-    {
-        printf("RKNN初始化失败! ret=%d\n", ret);
-        return -1;
-    }
-    printf("RKNN上下文初始化成功\n");
-
-    // 设置NPU核心掩码
-    printf("正在设置NPU核心掩码 (RKNN_NPU_CORE_0_1_2)...\n");
-    ret = rknn_set_core_mask(ctx, RKNN_NPU_CORE_0_1_2);
-    if (ret != RKNN_SUCC)
-    {
-        printf("NPU核心掩码设置失败! ret=%d\n", ret);
-        return -1;
-    }
-    printf("NPU核心掩码设置成功，将使用所有3个NPU核心\n");
 
     // Get Model Input Output Number
     printf("正在查询模型输入输出数量...\n");
@@ -122,9 +87,6 @@ int init_yolov6_model(const char *model_path, rknn_app_context_t *app_ctx)
                output_attrs[i].type);
     }
 
-    // Set to context
-    app_ctx->rknn_ctx = ctx;
-
     // 检查模型是否为量化模型
     if (output_attrs[0].qnt_type == RKNN_TENSOR_QNT_AFFINE_ASYMMETRIC && output_attrs[0].type == RKNN_TENSOR_INT8)
     {
@@ -142,6 +104,11 @@ int init_yolov6_model(const char *model_path, rknn_app_context_t *app_ctx)
     memcpy(app_ctx->input_attrs, input_attrs, io_num.n_input * sizeof(rknn_tensor_attr));
     app_ctx->output_attrs = (rknn_tensor_attr *)malloc(io_num.n_output * sizeof(rknn_tensor_attr));
     memcpy(app_ctx->output_attrs, output_attrs, io_num.n_output * sizeof(rknn_tensor_attr));
+    if (app_ctx->is_quant && init_qnt_luts(app_ctx) != 0)
+    {
+        printf("量化查找表创建失败!\n");
+        return -1;
+    }
 
     if (input_attrs[0].fmt == RKNN_TENSOR_NCHW)
     {
@@ -157,15 +124,331 @@ int init_yolov6_model(const char *model_path, rknn_app_context_t *app_ctx)
     }
     printf("模型输入尺寸: %dx%dx%d (HxWxC)\n",
            app_ctx->model_height, app_ctx->model_width, app_ctx->model_channel);
+
+    if (init_post_process_buf(app_ctx) != 0)
+    {
+        printf("后处理缓冲区分配失败!\n");
+        return -1;
+    }
+    return 0;
+}
+
+// 为输入分配两块NPU可见的张量内存，失败时回退到 rknn_inputs_set 拷贝路径
+static int init_npu_input_mem(rknn_app_context_t *app_ctx)
+{
+    int ret;
+    rknn_tensor_attr *attr = &app_ctx->npu_input_attr;
+
+    memcpy(attr, &app_ctx->input_attrs[0], sizeof(rknn_tensor_attr));
+    attr->type = RKNN_TENSOR_UINT8;
+    attr->fmt = RKNN_TENSOR_NHWC;
+    attr->pass_through = 0;
+
+    uint32_t size = attr->size_with_stride > 0 ? attr->size_with_stride : attr->size;
+    for (int i = 0; i < 2; i++)
+    {
+        // 优先使用缓冲池的 DMA 缓冲，解码/RGA/NPU 共用同一批 fd；没有 DMA heap 时由运行时分配
+        image_buffer_t *buf = &app_ctx->npu_input_bufs[i];
+        memset(buf, 0, sizeof(image_buffer_t));
+        buf->width = app_ctx->model_width;
+        buf->height = app_ctx->model_height;
+        buf->width_stride = attr->w_stride;
+        buf->format = IMAGE_FORMAT_RGB888;
+        buf->size = size;
+        if (alloc_image_buffer(buf) == 0 && buf->fd <= 0)
+        {
+            free_image_buffer(buf);
+        }
+        if (buf->virt_addr != NULL)
+        {
+            app_ctx->npu_input_mems[i] = rknn_create_mem_from_fd(app_ctx->rknn_ctx, buf->fd, buf->virt_addr, size, 0);
+        }
+        else
+        {
+            app_ctx->npu_input_mems[i] = rknn_create_mem(app_ctx->rknn_ctx, size);
+        }
+        if (app_ctx->npu_input_mems[i] == NULL)
+        {
+            printf("输入张量内存分配失败，使用拷贝输入\n");
+            goto err;
+        }
+    }
+    ret = rknn_set_io_mem(app_ctx->rknn_ctx, app_ctx->npu_input_mems[0], attr);
+    if (ret < 0)
+    {
+        printf("输入张量内存绑定失败! ret=%d，使用拷贝输入\n", ret);
+        goto err;
+    }
+    app_ctx->npu_input_idx = 0;
+    app_ctx->npu_input_bound = 0;
+    printf("零拷贝输入已启用，输入张量大小: %d bytes\n", size);
+    return 0;
+
+err:
+    for (int i = 0; i < 2; i++)
+    {
+        if (app_ctx->npu_input_mems[i] != NULL)
+        {
+            rknn_destroy_mem(app_ctx->rknn_ctx, app_ctx->npu_input_mems[i]);
+            app_ctx->npu_input_mems[i] = NULL;
+        }
+        free_image_buffer(&app_ctx->npu_input_bufs[i]);
+    }
+    return -1;
+}
+
+// 查询输出张量的NPU原生布局，优先 NHWC，其次 NC1HWC2，
+// 绑定原生布局后运行时不再做布局转换，后处理直接按原生布局读取
+static void query_native_output_attr(rknn_app_context_t *app_ctx, int index, rknn_tensor_attr *attr)
+{
+    const rknn_query_cmd cmds[2] = {RKNN_QUERY_NATIVE_NHWC_OUTPUT_ATTR, RKNN_QUERY_NATIVE_NC1HWC2_OUTPUT_ATTR};
+    const rknn_tensor_format fmts[2] = {RKNN_TENSOR_NHWC, RKNN_TENSOR_NC1HWC2};
+    const rknn_tensor_attr *logical = &app_ctx->output_attrs[index];
+
+    for (int k = 0; k < 2; k++)
+    {
+        memset(attr, 0, sizeof(rknn_tensor_attr));
+        attr->index = index;
+        int ret = rknn_query(app_ctx->rknn_ctx, cmds[k], attr, sizeof(rknn_tensor_attr));
+        if (ret != RKNN_SUCC || attr->fmt != fmts[k] || attr->type != logical->type)
+        {
+            continue;
+        }
+        // 后处理按 网格 = h * w 线性寻址，宽度方向有填充时不能使用
+        uint32_t w = attr->fmt == RKNN_TENSOR_NHWC ? attr->dims[2] : attr->dims[3];
+        if (attr->w_stride != 0 && attr->w_stride != w)
+        {
+            continue;
+        }
+        printf("输出 %d 使用原生布局 %s, dims=[%d, %d, %d, %d, %d]\n", index, get_format_string(attr->fmt),
+               attr->dims[0], attr->dims[1], attr->dims[2], attr->dims[3], attr->dims[4]);
+        return;
+    }
+    memcpy(attr, logical, sizeof(rknn_tensor_attr));
+}
+
+// 输出张量常驻绑定，NPU直接写入；init 时关闭了运行时的输出 cache 刷新，
+// 由后处理只对实际读取的张量调用 rknn_mem_sync
+static int init_npu_output_mem(rknn_app_context_t *app_ctx)
+{
+    int ret;
+
+    // 浮点模型需要运行时做类型转换，只能走 rknn_outputs_get
+    if (!app_ctx->is_quant || app_ctx->io_num.n_output > YOLOV6_MAX_OUTPUTS)
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < app_ctx->io_num.n_output; i++)
+    {
+        rknn_tensor_attr *attr = &app_ctx->npu_output_attrs[i];
+        query_native_output_attr(app_ctx, i, attr);
+        uint32_t size = attr->size_with_stride > 0 ? attr->size_with_stride : attr->size;
+        app_ctx->npu_output_mems[i] = rknn_create_mem(app_ctx->rknn_ctx, size);
+        if (app_ctx->npu_output_mems[i] == NULL)
+        {
+            printf("输出张量 %d 内存分配失败\n", i);
+            goto err;
+        }
+        ret = rknn_set_io_mem(app_ctx->rknn_ctx, app_ctx->npu_output_mems[i], attr);
+        if (ret < 0)
+        {
+            printf("输出张量 %d 内存绑定失败! ret=%d\n", i, ret);
+            goto err;
+        }
+    }
+    printf("零拷贝输出已启用\n");
+    return 0;
+
+err:
+    for (int i = 0; i < YOLOV6_MAX_OUTPUTS; i++)
+    {
+        if (app_ctx->npu_output_mems[i] != NULL)
+        {
+            rknn_destroy_mem(app_ctx->rknn_ctx, app_ctx->npu_output_mems[i]);
+            app_ctx->npu_output_mems[i] = NULL;
+        }
+    }
+    return -1;
+}
+
+static int init_yolov6_context(char *model, int model_len, uint32_t init_flag, rknn_app_context_t *app_ctx)
+{
+    int ret;
+    rknn_context ctx = 0;
+
+    printf("正在初始化RKNN上下文 (flag=0x%x)...\n", init_flag);
+    ret = rknn_init(&ctx, model, model_len, init_flag, NULL);
+    if (ret < 0)
+    {
+        printf("RKNN初始化失败! ret=%d\n", ret);
+        return -1;
+    }
+    printf("RKNN上下文初始化成功\n");
+
+    // Set to context
+    app_ctx->rknn_ctx = ctx;
+    app_ctx->init_flag = init_flag;
+
+    // 设置NPU核心掩码
+    printf("正在设置NPU核心掩码 (RKNN_NPU_CORE_0_1_2)...\n");
+    ret = rknn_set_core_mask(ctx, RKNN_NPU_CORE_0_1_2);
+    if (ret != RKNN_SUCC)
+    {
+        printf("NPU核心掩码设置失败! ret=%d\n", ret);
+        return -1;
+    }
+    printf("NPU核心掩码设置成功，将使用所有3个NPU核心\n");
+    app_ctx->core_mask = RKNN_NPU_CORE_0_1_2;
+
+    ret = query_yolov6_model_info(ctx, app_ctx);
+    if (ret != 0)
+    {
+        return -1;
+    }
+    init_npu_input_mem(app_ctx);
+
+    if (init_flag & RKNN_FLAG_DISABLE_FLUSH_OUTPUT_MEM_CACHE)
+    {
+        ret = init_npu_output_mem(app_ctx);
+        if (ret != 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int init_yolov6_model(const char *model_path, rknn_app_context_t *app_ctx)
+{
+    int ret;
+    int model_len = 0;
+    char *model = NULL;
+
+    printf("开始初始化YOLOv6模型...\n");
+    printf("模型路径: %s\n", model_path);
+
+    // Load RKNN Model
+    printf("正在加载RKNN模型文件...\n");
+    model_len = read_data_from_file(model_path, &model);
+    if (model == NULL)
+    {
+        printf("模型文件加载失败!\n");
+        return -1;
+    }
+    printf("模型文件加载成功，大小: %d bytes\n", model_len);
+
+    ret = init_yolov6_context(model, model_len, RKNN_FLAG_DISABLE_FLUSH_OUTPUT_MEM_CACHE, app_ctx);
+    if (ret == 1)
+    {
+        // 不能零拷贝输出时必须去掉该标志重新初始化，否则 rknn_outputs_get 读到的可能是旧数据
+        printf("零拷贝输出不可用，使用 rknn_outputs_get 重新初始化\n");
+        release_yolov6_model(app_ctx);
+        ret = init_yolov6_context(model, model_len, 0, app_ctx);
+    }
+    free(model);
+    if (ret != 0)
+    {
+        release_yolov6_model(app_ctx);
+        return -1;
+    }
     printf("YOLOv6模型初始化完成!\n");
 
     return 0;
 }
 
+int dup_yolov6_model(rknn_app_context_t *src_ctx, rknn_app_context_t *dst_ctx, rknn_core_mask core_mask)
+{
+    int ret;
+    rknn_context ctx = 0;
+
+    if (src_ctx == NULL || dst_ctx == NULL || src_ctx->rknn_ctx == 0)
+    {
+        printf("复制模型参数错误: src_ctx=%p, dst_ctx=%p\n", src_ctx, dst_ctx);
+        return -1;
+    }
+
+    // 复制出的上下文与源上下文共享权重，只额外分配中间和输入输出内存
+    ret = rknn_dup_context(&src_ctx->rknn_ctx, &ctx);
+    if (ret != RKNN_SUCC)
+    {
+        printf("RKNN上下文复制失败! ret=%d\n", ret);
+        return -1;
+    }
+
+    ret = rknn_set_core_mask(ctx, core_mask);
+    if (ret != RKNN_SUCC)
+    {
+        printf("NPU核心掩码设置失败! ret=%d core_mask=%d\n", ret, core_mask);
+        rknn_destroy(ctx);
+        return -1;
+    }
+
+    dst_ctx->rknn_ctx = ctx;
+    dst_ctx->core_mask = core_mask;
+
+    ret = query_yolov6_model_info(ctx, dst_ctx);
+    if (ret != 0)
+    {
+        release_yolov6_model(dst_ctx);
+        return -1;
+    }
+    dst_ctx->init_flag = src_ctx->init_flag;
+    init_npu_input_mem(dst_ctx);
+    if (src_ctx->npu_output_mems[0] != NULL)
+    {
+        ret = init_npu_output_mem(dst_ctx);
+        if (ret != 0)
+        {
+            release_yolov6_model(dst_ctx);
+            return -1;
+        }
+    }
+    return 0;
+}
+
 int release_yolov6_model(rknn_app_context_t *app_ctx)
 {
     printf("开始释放YOLOv6模型资源...\n");
 
+    if (app_ctx->pending && app_ctx->rknn_ctx != 0)
+    {
+        rknn_wait(app_ctx->rknn_ctx, &app_ctx->pending_run);
+        app_ctx->pending = 0;
+    }
+    app_ctx->ready = 0;
+    for (int i = 0; i < 2; i++)
+    {
+        if (app_ctx->npu_input_mems[i] != NULL)
+        {
+            // letterbox 缓存的 RGA 句柄随 fd 一起失效
+            image_buffer_t npu_img;
+            memset(&npu_img, 0, sizeof(image_buffer_t));
+            npu_img.fd = app_ctx->npu_input_mems[i]->fd;
+            if (app_ctx->npu_input_bufs[i].virt_addr == NULL)
+            {
+                invalidate_image_handle(&npu_img);
+            }
+            rknn_destroy_mem(app_ctx->rknn_ctx, app_ctx->npu_input_mems[i]);
+            app_ctx->npu_input_mems[i] = NULL;
+        }
+        // 池中的缓冲 fd 保持打开，句柄缓存到真正释放时再失效
+        free_image_buffer(&app_ctx->npu_input_bufs[i]);
+    }
+    for (int i = 0; i < YOLOV6_MAX_OUTPUTS; i++)
+    {
+        if (app_ctx->npu_output_mems[i] != NULL)
+        {
+            rknn_destroy_mem(app_ctx->rknn_ctx, app_ctx->npu_output_mems[i]);
+            app_ctx->npu_output_mems[i] = NULL;
+        }
+    }
+    if (app_ctx->input_img.virt_addr != NULL)
+    {
+        free(app_ctx->input_img.virt_addr);
+        app_ctx->input_img.virt_addr = NULL;
+    }
+
     if (app_ctx->input_attrs != NULL)
     {
         free(app_ctx->input_attrs);
@@ -178,6 +461,12 @@ int release_yolov6_model(rknn_app_context_t *app_ctx)
         app_ctx->output_attrs = NULL;
         printf("已释放输出属性内存\n");
     }
+    if (app_ctx->output_luts != NULL)
+    {
+        free(app_ctx->output_luts);
+        app_ctx->output_luts = NULL;
+    }
+    release_post_process_buf(app_ctx);
     if (app_ctx->rknn_ctx != 0)
     {
         rknn_destroy(app_ctx->rknn_ctx);
@@ -188,130 +477,337 @@ int release_yolov6_model(rknn_app_context_t *app_ctx)
     return 0;
 }
 
-int inference_yolov6_model(rknn_app_context_t *app_ctx, image_buffer_t *img, object_detect_result_list *od_results)
+// 收取NPU上未完成的一帧：等待结束、取输出并后处理，结果保存在 ready_results
+static int complete_pending_job(rknn_app_context_t *app_ctx)
 {
     int ret;
-    image_buffer_t dst_img;
-    letterbox_t letter_box;
-    rknn_input inputs[app_ctx->io_num.n_input];
     rknn_output outputs[app_ctx->io_num.n_output];
     const float nms_threshold = NMS_THRESH;      // 默认的NMS阈值
     const float box_conf_threshold = BOX_THRESH; // 默认的置信度阈值
-    int bg_color = 114;
 
-    // Time measurement variables
-    long long start_time, preprocess_time = 0, inference_time = 0, postprocess_time = 0, total_time;
-    long long postprocess_start = 0;
+    if (!app_ctx->pending)
+    {
+        return 0;
+    }
+    app_ctx->pending = 0;
 
-    start_time = get_current_time_ms();
+    long long wait_start = get_current_time_ms();
+    ret = rknn_wait(app_ctx->rknn_ctx, &app_ctx->pending_run);
+    if (ret < 0)
+    {
+        printf("NPU推理失败! ret=%d\n", ret);
+        return -1;
+    }
 
-    if ((!app_ctx) || !(img) || (!od_results))
+    if (app_ctx->npu_output_mems[0] != NULL)
     {
-        printf("推理参数错误: app_ctx=%p, img=%p, od_results=%p\n", app_ctx, img, od_results);
+        // 输出已在常驻张量中，后处理按需同步 cache 后原地读取
+        app_ctx->inference_time += get_current_time_ms() - wait_start;
+        long long postprocess_start = get_current_time_ms();
+        post_process(app_ctx, NULL, &app_ctx->pending_letterbox, box_conf_threshold, nms_threshold, &app_ctx->ready_results);
+        app_ctx->postprocess_time = get_current_time_ms() - postprocess_start;
+    }
+    else
+    {
+        memset(outputs, 0, sizeof(outputs));
+        for (int i = 0; i < app_ctx->io_num.n_output; i++)
+        {
+            outputs[i].index = i;
+            outputs[i].want_float = (!app_ctx->is_quant);
+        }
+        ret = rknn_outputs_get(app_ctx->rknn_ctx, app_ctx->io_num.n_output, outputs, NULL);
+        app_ctx->inference_time += get_current_time_ms() - wait_start;
+        if (ret < 0)
+        {
+            printf("获取推理结果失败! ret=%d\n", ret);
+            return -1;
+        }
+
+        long long postprocess_start = get_current_time_ms();
+        post_process(app_ctx, outputs, &app_ctx->pending_letterbox, box_conf_threshold, nms_threshold, &app_ctx->ready_results);
+        app_ctx->postprocess_time = get_current_time_ms() - postprocess_start;
+
+        // Remeber to release rknn output
+        rknn_outputs_release(app_ctx->rknn_ctx, app_ctx->io_num.n_output, outputs);
+    }
+
+    app_ctx->ready_tag = app_ctx->pending_tag;
+    app_ctx->ready = 1;
+    return 0;
+}
+
+static int check_submit(rknn_app_context_t *app_ctx, image_buffer_t *img)
+{
+    if ((!app_ctx) || !(img))
+    {
+        printf("推理参数错误: app_ctx=%p, img=%p\n", app_ctx, img);
+        return -1;
+    }
+    if (app_ctx->ready)
+    {
+        printf("上一帧结果尚未取走 (tag=%ld)，请先调用 yolov6_wait\n", app_ctx->ready_tag);
         return -1;
     }
+    return 0;
+}
 
-    memset(od_results, 0x00, sizeof(*od_results));
-    memset(&letter_box, 0, sizeof(letterbox_t));
-    memset(&dst_img, 0, sizeof(image_buffer_t));
+// letterbox 的目标: 零拷贝时是空闲的那块输入张量，否则是常驻的 input_img
+static image_buffer_t *get_input_image(rknn_app_context_t *app_ctx, image_buffer_t *npu_img)
+{
+    image_buffer_t *dst_img = &app_ctx->input_img;
+    if (app_ctx->npu_input_mems[0] != NULL)
+    {
+        // 直接写入空闲的那块输入张量
+        rknn_tensor_mem *mem = app_ctx->npu_input_mems[app_ctx->npu_input_idx];
+        memset(npu_img, 0, sizeof(image_buffer_t));
+        npu_img->width = app_ctx->model_width;
+        npu_img->height = app_ctx->model_height;
+        npu_img->width_stride = app_ctx->npu_input_attr.w_stride;   // 行有填充时 letterbox 按跨距写入
+        npu_img->format = IMAGE_FORMAT_RGB888;
+        npu_img->virt_addr = (unsigned char *)mem->virt_addr;
+        npu_img->fd = mem->fd;
+        npu_img->size = mem->size;
+        dst_img = npu_img;
+    }
+    else if (dst_img->virt_addr == NULL)
+    {
+        dst_img->width = app_ctx->model_width;
+        dst_img->height = app_ctx->model_height;
+        dst_img->format = IMAGE_FORMAT_RGB888;
+        dst_img->size = get_image_size(dst_img);
+        dst_img->virt_addr = (unsigned char *)malloc(dst_img->size);
+        if (dst_img->virt_addr == NULL)
+        {
+            printf("预处理内存分配失败!\n");
+            return NULL;
+        }
+    }
+    return dst_img;
+}
+
+// 预处理完成后收取上一帧，设置输入并启动NPU
+static int start_inference(rknn_app_context_t *app_ctx, image_buffer_t *dst_img, letterbox_t *letter_box, long tag)
+{
+    int ret;
+    rknn_input inputs[app_ctx->io_num.n_input];
     memset(inputs, 0, sizeof(inputs));
-    memset(outputs, 0, sizeof(outputs));
 
-    printf("开始预处理...\n");
-    // Pre Process
+    // NPU同一时间只能运行一帧，先把上一帧收取完
+    ret = complete_pending_job(app_ctx);
+    if (ret < 0)
+    {
+        return -1;
+    }
+
+    if (app_ctx->npu_input_mems[0] != NULL)
+    {
+        int input_idx = app_ctx->npu_input_idx;
+        if (app_ctx->npu_input_bound != input_idx)
+        {
+            ret = rknn_set_io_mem(app_ctx->rknn_ctx, app_ctx->npu_input_mems[input_idx], &app_ctx->npu_input_attr);
+            if (ret < 0)
+            {
+                printf("输入张量内存绑定失败! ret=%d\n", ret);
+                return -1;
+            }
+            app_ctx->npu_input_bound = input_idx;
+        }
+        app_ctx->npu_input_idx = input_idx ^ 1;
+    }
+    else
+    {
+        // Set Input Data
+        inputs[0].index = 0;
+        inputs[0].type = RKNN_TENSOR_UINT8;
+        inputs[0].fmt = RKNN_TENSOR_NHWC;
+        inputs[0].size = app_ctx->model_width * app_ctx->model_height * app_ctx->model_channel;
+        inputs[0].buf = dst_img->virt_addr;
+
+        ret = rknn_inputs_set(app_ctx->rknn_ctx, app_ctx->io_num.n_input, inputs);
+        if (ret < 0)
+        {
+            printf("输入数据设置失败! ret=%d\n", ret);
+            return -1;
+        }
+    }
+
+    // Run
+    long long inference_start = get_current_time_ms();
+    memset(&app_ctx->pending_run, 0, sizeof(rknn_run_extend));
+    app_ctx->pending_run.non_block = 1;
+    ret = rknn_run(app_ctx->rknn_ctx, &app_ctx->pending_run);
+    app_ctx->inference_time = get_current_time_ms() - inference_start;
+    if (ret < 0)
+    {
+        printf("NPU推理启动失败! ret=%d\n", ret);
+        return -1;
+    }
+
+    app_ctx->pending_letterbox = *letter_box;
+    app_ctx->pending_tag = tag;
+    app_ctx->pending = 1;
+    return 0;
+}
+
+int yolov6_submit(rknn_app_context_t *app_ctx, image_buffer_t *img, long tag)
+{
+    int ret;
+    letterbox_t letter_box;
+    int bg_color = 114;
+
+    if (check_submit(app_ctx, img) != 0)
+    {
+        return -1;
+    }
+    memset(&letter_box, 0, sizeof(letterbox_t));
+
+    // Pre Process，与NPU上正在运行的上一帧重叠执行
     long long preprocess_start = get_current_time_ms();
-    dst_img.width = app_ctx->model_width;
-    dst_img.height = app_ctx->model_height;
-    dst_img.format = IMAGE_FORMAT_RGB888;
-    dst_img.size = get_image_size(&dst_img);
-    dst_img.virt_addr = (unsigned char *)malloc(dst_img.size);
-    if (dst_img.virt_addr == NULL)
-    {
-        printf("预处理内存分配失败!\n");
+    image_buffer_t npu_img;
+    image_buffer_t *dst_img = get_input_image(app_ctx, &npu_img);
+    if (dst_img == NULL)
+    {
         return -1;
     }
 
     // letterbox
-    printf("正在执行letterbox变换 (输入: %dx%d -> 输出: %dx%d)...\n",
-           img->width, img->height, dst_img.width, dst_img.height);
-    ret = convert_image_with_letterbox(img, &dst_img, &letter_box, bg_color);
+    ret = convert_image_with_letterbox(img, dst_img, &letter_box, bg_color);
     if (ret < 0)
     {
         printf("letterbox变换失败!\n");
         return -1;
     }
-    preprocess_time = get_current_time_ms() - preprocess_start;
-    printf("预处理完成，耗时: %lld ms\n", preprocess_time);
+    app_ctx->preprocess_time = get_current_time_ms() - preprocess_start;
 
-    // Set Input Data
-    printf("正在设置输入数据...\n");
-    inputs[0].index = 0;
-    inputs[0].type = RKNN_TENSOR_UINT8;
-    inputs[0].fmt = RKNN_TENSOR_NHWC;
-    inputs[0].size = app_ctx->model_width * app_ctx->model_height * app_ctx->model_channel;
-    inputs[0].buf = dst_img.virt_addr;
+    return start_inference(app_ctx, dst_img, &letter_box, tag);
+}
 
-    ret = rknn_inputs_set(app_ctx->rknn_ctx, app_ctx->io_num.n_input, inputs);
-    if (ret < 0)
+int yolov6_submit_batch(rknn_app_context_t **app_ctxs, image_buffer_t **imgs, long *tags, int count)
+{
+    int ret;
+    letterbox_t letter_boxes[IMAGE_CONVERT_BATCH_MAX];
+    image_buffer_t npu_imgs[IMAGE_CONVERT_BATCH_MAX];
+    image_buffer_t *dst_imgs[IMAGE_CONVERT_BATCH_MAX];
+    int bg_color = 114;
+
+    if (app_ctxs == NULL || imgs == NULL || count < 1 || count > IMAGE_CONVERT_BATCH_MAX)
     {
-        printf("输入数据设置失败! ret=%d\n", ret);
+        printf("批量推理参数错误: count=%d\n", count);
         return -1;
     }
-    printf("输入数据设置成功\n");
+    for (int i = 0; i < count; i++)
+    {
+        if (check_submit(app_ctxs[i], imgs[i]) != 0)
+        {
+            return -1;
+        }
+        for (int j = 0; j < i; j++)
+        {
+            if (app_ctxs[j] == app_ctxs[i])
+            {
+                printf("同一批次中上下文重复: %p\n", app_ctxs[i]);
+                return -1;
+            }
+        }
+    }
+    memset(letter_boxes, 0, sizeof(letter_boxes));
 
-    // Run
-    printf("开始NPU推理...\n");
-    long long inference_start = get_current_time_ms();
-    ret = rknn_run(app_ctx->rknn_ctx, nullptr);
-    inference_time = get_current_time_ms() - inference_start;
+    // 所有帧的 letterbox 作为一个RGA任务提交
+    long long preprocess_start = get_current_time_ms();
+    for (int i = 0; i < count; i++)
+    {
+        dst_imgs[i] = get_input_image(app_ctxs[i], &npu_imgs[i]);
+        if (dst_imgs[i] == NULL)
+        {
+            return -1;
+        }
+    }
+    ret = convert_image_with_letterbox_batch(imgs, dst_imgs, letter_boxes, count, bg_color);
     if (ret < 0)
     {
-        printf("NPU推理失败! ret=%d\n", ret);
+        printf("letterbox变换失败!\n");
         return -1;
     }
-    printf("NPU推理完成，耗时: %lld ms\n", inference_time);
+    long long preprocess_time = get_current_time_ms() - preprocess_start;
 
-    // Get Output
-    printf("正在获取推理结果...\n");
-    memset(outputs, 0, sizeof(outputs));
-    for (int i = 0; i < app_ctx->io_num.n_output; i++)
+    for (int i = 0; i < count; i++)
     {
-        outputs[i].index = i;
-        outputs[i].want_float = (!app_ctx->is_quant);
+        app_ctxs[i]->preprocess_time = preprocess_time;
+        ret = start_inference(app_ctxs[i], dst_imgs[i], &letter_boxes[i], tags != NULL ? tags[i] : 0);
+        if (ret < 0)
+        {
+            return -1;
+        }
     }
-    ret = rknn_outputs_get(app_ctx->rknn_ctx, app_ctx->io_num.n_output, outputs, NULL);
-    if (ret < 0)
+    return 0;
+}
+
+int yolov6_wait(rknn_app_context_t *app_ctx, object_detect_result_list *od_results, long *tag)
+{
+    int ret;
+
+    if ((!app_ctx) || (!od_results))
     {
-        printf("获取推理结果失败! ret=%d\n", ret);
-        goto out;
+        printf("推理参数错误: app_ctx=%p, od_results=%p\n", app_ctx, od_results);
+        return -1;
+    }
+
+    if (!app_ctx->ready)
+    {
+        if (!app_ctx->pending)
+        {
+            printf("没有已提交的推理任务\n");
+            return -1;
+        }
+        ret = complete_pending_job(app_ctx);
+        if (ret < 0)
+        {
+            return -1;
+        }
     }
-    printf("推理结果获取成功，共 %d 个输出\n", app_ctx->io_num.n_output);
 
-    // Post Process
-    printf("开始后处理 (NMS和过滤)...\n");
-    postprocess_start = get_current_time_ms();
-    post_process(app_ctx, outputs, &letter_box, box_conf_threshold, nms_threshold, od_results);
-    postprocess_time = get_current_time_ms() - postprocess_start;
-    printf("后处理完成，耗时: %lld ms\n", postprocess_time);
+    memcpy(od_results, &app_ctx->ready_results, sizeof(object_detect_result_list));
+    if (tag != NULL)
+    {
+        *tag = app_ctx->ready_tag;
+    }
+    app_ctx->ready = 0;
+    return 0;
+}
 
-    // Remeber to release rknn output
-    rknn_outputs_release(app_ctx->rknn_ctx, app_ctx->io_num.n_output, outputs);
+int inference_yolov6_model(rknn_app_context_t *app_ctx, image_buffer_t *img, object_detect_result_list *od_results)
+{
+    int ret;
 
-out:
-    if (dst_img.virt_addr != NULL)
+    if ((!app_ctx) || !(img) || (!od_results))
     {
-        free(dst_img.virt_addr);
+        printf("推理参数错误: app_ctx=%p, img=%p, od_results=%p\n", app_ctx, img, od_results);
+        return -1;
     }
 
-    total_time = get_current_time_ms() - start_time;
+    memset(od_results, 0x00, sizeof(*od_results));
+
+    ret = yolov6_submit(app_ctx, img, 0);
+    if (ret < 0)
+    {
+        return ret;
+    }
+    ret = yolov6_wait(app_ctx, od_results, NULL);
+    if (ret < 0)
+    {
+        return ret;
+    }
 
     // 推理性能统计 (只统计NPU推理和后处理)
+    long long inference_time = app_ctx->inference_time;
+    long long postprocess_time = app_ctx->postprocess_time;
     long long core_inference_time = inference_time + postprocess_time;
     printf("=== 推理性能统计 ===\n");
+    printf("预处理: %lld ms\n", app_ctx->preprocess_time);
     printf("NPU推理: %lld ms (%.1f%%)\n", inference_time, (float)inference_time / core_inference_time * 100);
     printf("后处理: %lld ms (%.1f%%)\n", postprocess_time, (float)postprocess_time / core_inference_time * 100);
     printf("核心推理总耗时: %lld ms (100%%)\n", core_inference_time);
     printf("===================\n");
 
     return ret;
-}
\ No newline at end of file
+}
@@ -0,0 +1,358 @@
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "file_utils.h"
+#include "watch_folder.h"
+
+typedef struct {
+    const watch_options_t *options;
+    result_sink_t *sink;
+} watch_context_t;
+
+// 启动时扫描提交的文件名，按 strcmp 升序（walk_image_files 的排序）
+typedef struct {
+    char **names;
+    int count;
+    int capacity;
+} name_list_t;
+
+typedef struct {
+    batch_pipeline_t *pipe;
+    name_list_t *scanned;
+} existing_scan_t;
+
+static volatile sig_atomic_t watch_stop;
+
+static void on_stop_signal(int)
+{
+    watch_stop = 1;
+}
+
+static const char *get_file_name(const char *path)
+{
+    const char *name = strrchr(path, '/');
+    return name != NULL ? name + 1 : path;
+}
+
+// 先写临时文件再改名，下游看到 .json 时内容已经完整
+static void write_sidecar(const char *dir, const char *name, const char *image_path, int width, int height,
+                          const object_detect_result_list *od_results)
+{
+    char tmp_path[PATH_MAX * 2];
+    char json_path[PATH_MAX * 2];
+    int json_len = snprintf(json_path, sizeof(json_path), "%s/%s.json", dir, name);
+    int tmp_len = snprintf(tmp_path, sizeof(tmp_path), "%s/.%s.json.tmp", dir, name);
+    if (json_len < 0 || tmp_len < 0 || (size_t)json_len >= sizeof(json_path) || (size_t)tmp_len >= sizeof(tmp_path))
+    {
+        printf("结果文件路径过长，跳过: %s/%s.json\n", dir, name);
+        return;
+    }
+
+    result_sink_t sidecar;
+    if (open_result_sink(tmp_path, RESULT_SINK_JSONL, &sidecar) != 0)
+    {
+        return;
+    }
+    result_sink_write(&sidecar, 0, image_path, width, height, od_results);
+    if (close_result_sink(&sidecar) != 0 || rename(tmp_path, json_path) != 0)
+    {
+        printf("结果文件写入失败: %s\n", json_path);
+        unlink(tmp_path);
+    }
+}
+
+// 后处理线程上按输入顺序调用
+static void on_image_done(void *user_data, const char *path, int width, int height,
+                          const object_detect_result_list *od_results)
+{
+    watch_context_t *watch = (watch_context_t *)user_data;
+    const watch_options_t *options = watch->options;
+    const char *name = get_file_name(path);
+
+    // 长时间运行，每张图片的结果都及时落盘
+    if (watch->sink != NULL && watch->sink->fp != NULL)
+    {
+        fflush(watch->sink->fp);
+    }
+
+    if (options->sidecar)
+    {
+        char dir[PATH_MAX];
+        if (options->done_dir != NULL)
+        {
+            snprintf(dir, sizeof(dir), "%s", options->done_dir);
+        }
+        else
+        {
+            // 提交的路径总是 <监视目录>/<文件名>
+            snprintf(dir, sizeof(dir), "%.*s", (int)(name - path - 1), path);
+        }
+        write_sidecar(dir, name, path, width, height, od_results);
+    }
+
+    if (options->done_dir != NULL)
+    {
+        char done_path[PATH_MAX];
+        snprintf(done_path, sizeof(done_path), "%s/%s", options->done_dir, name);
+        if (rename(path, done_path) != 0)
+        {
+            printf("移动文件失败: %s -> %s (%s)\n", path, done_path, strerror(errno));
+        }
+    }
+}
+
+static void push_image(batch_pipeline_t *pipe, const char *dir, const char *name)
+{
+    char path[PATH_MAX];
+    if (!is_image_file(name))
+    {
+        return;
+    }
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    // 启动时列出的已有文件可能再收到一次事件，已经移走的不再提交
+    if (access(path, F_OK) != 0)
+    {
+        return;
+    }
+    if (batch_pipeline_push(pipe, path) != 0)
+    {
+        printf("提交图片失败: %s\n", path);
+    }
+}
+
+static void free_name_list(name_list_t *list)
+{
+    for (int i = 0; i < list->count; i++)
+    {
+        free(list->names[i]);
+    }
+    free(list->names);
+    memset(list, 0, sizeof(name_list_t));
+}
+
+static int compare_name(const void *a, const void *b)
+{
+    return strcmp((const char *)a, *(char *const *)b);
+}
+
+static int name_list_contains(const name_list_t *list, const char *name)
+{
+    return list->count > 0 && bsearch(name, list->names, list->count, sizeof(char *), compare_name) != NULL;
+}
+
+static int push_existing_image(const char *path, void *user_data)
+{
+    existing_scan_t *scan = (existing_scan_t *)user_data;
+    name_list_t *list = scan->scanned;
+    if (watch_stop)
+    {
+        return 1;
+    }
+    if (batch_pipeline_push(scan->pipe, path) != 0)
+    {
+        printf("提交图片失败: %s\n", path);
+        return 0;
+    }
+    if (list->count >= list->capacity)
+    {
+        int capacity = list->capacity > 0 ? list->capacity * 2 : 64;
+        char **names = (char **)realloc(list->names, capacity * sizeof(char *));
+        if (names == NULL)
+        {
+            return 0;
+        }
+        list->names = names;
+        list->capacity = capacity;
+    }
+    char *name = strdup(get_file_name(path));
+    if (name != NULL)
+    {
+        list->names[list->count++] = name;
+    }
+    return 0;
+}
+
+// 移动到 done_dir 时，启动前已在目录里的图片都是上次没处理完的
+static void push_existing_images(batch_pipeline_t *pipe, const char *dir, name_list_t *scanned)
+{
+    existing_scan_t scan;
+    scan.pipe = pipe;
+    scan.scanned = scanned;
+    int image_count = walk_image_files(dir, NULL, FILE_WALK_SORTED, push_existing_image, &scan);
+    if (image_count > 0)
+    {
+        printf("已提交目录中原有的 %d 个图片文件\n", image_count);
+    }
+}
+
+// 读取一批 inotify 事件并提交图片，skip 中的文件名已经提交过，直接丢弃。
+// 返回 0 继续监视，-1 出错或被监视的目录已删除
+static int handle_events(int fd, batch_pipeline_t *pipe, const char *dir, const name_list_t *skip)
+{
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t len = read(fd, buf, sizeof(buf));
+    if (len < 0)
+    {
+        if (errno == EINTR || errno == EAGAIN)
+        {
+            return 0;
+        }
+        printf("读取 inotify 事件失败: %s\n", strerror(errno));
+        return -1;
+    }
+    for (char *p = buf; p < buf + len;)
+    {
+        struct inotify_event *event = (struct inotify_event *)p;
+        p += sizeof(struct inotify_event) + event->len;
+        if (event->mask & IN_Q_OVERFLOW)
+        {
+            printf("inotify 事件队列溢出，部分文件可能未处理\n");
+            continue;
+        }
+        if (event->mask & IN_IGNORED)
+        {
+            // 被监视的目录已删除
+            printf("监视的目录已不存在: %s\n", dir);
+            return -1;
+        }
+        // 跳过子目录、隐藏文件（包括结果的临时文件）和流水线自己写出的画框图片
+        if ((event->mask & IN_ISDIR) || event->len == 0 || event->name[0] == '.' ||
+            strncmp(event->name, BATCH_OUTPUT_PREFIX, strlen(BATCH_OUTPUT_PREFIX)) == 0)
+        {
+            continue;
+        }
+        if (skip != NULL && name_list_contains(skip, event->name))
+        {
+            continue;
+        }
+        push_image(pipe, dir, event->name);
+    }
+    return 0;
+}
+
+// 监视先于扫描开始，扫描期间写完的文件既在扫描结果里也有事件。
+// 扫描后把已经排队的事件读完，丢弃扫描时提交过的文件
+static int drain_pending_events(int fd, batch_pipeline_t *pipe, const char *dir, const name_list_t *scanned)
+{
+    while (!watch_stop)
+    {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, 0) <= 0)
+        {
+            return 0;
+        }
+        if (handle_events(fd, pipe, dir, scanned) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int watch_folder(const char *dir, yolov6_pool_t *pool, batch_pipeline_config_t *config,
+                 const watch_options_t *options)
+{
+    int ret = 0;
+    batch_pipeline_t *pipe = NULL;
+    watch_context_t watch;
+    watch.options = options;
+    watch.sink = config->sink;
+
+    if (options->done_dir != NULL && mkdir(options->done_dir, 0755) != 0 && errno != EEXIST)
+    {
+        printf("无法创建目录: %s (%s)\n", options->done_dir, strerror(errno));
+        return -1;
+    }
+
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0)
+    {
+        printf("inotify_init1 失败: %s\n", strerror(errno));
+        return -1;
+    }
+    // 只关心写完和移入的文件，写到一半的文件不会触发
+    if (inotify_add_watch(fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR) < 0)
+    {
+        printf("无法监视目录: %s (%s)\n", dir, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    config->on_done = on_image_done;
+    config->user_data = &watch;
+    if (init_batch_pipeline(pool, config, &pipe) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    // 不设 SA_RESTART，信号到达时 poll 返回 EINTR
+    struct sigaction sa;
+    struct sigaction old_int, old_term;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_stop_signal;
+    sigemptyset(&sa.sa_mask);
+    watch_stop = 0;
+    sigaction(SIGINT, &sa, &old_int);
+    sigaction(SIGTERM, &sa, &old_term);
+
+    if (options->done_dir != NULL)
+    {
+        name_list_t scanned;
+        memset(&scanned, 0, sizeof(name_list_t));
+        push_existing_images(pipe, dir, &scanned);
+        if (drain_pending_events(fd, pipe, dir, &scanned) != 0)
+        {
+            watch_stop = 1;
+            ret = -1;
+        }
+        free_name_list(&scanned);
+    }
+    if (!watch_stop)
+    {
+        printf("开始监视目录: %s (Ctrl+C 退出)\n", dir);
+    }
+
+    while (!watch_stop)
+    {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int n = poll(&pfd, 1, 1000);
+        if (n < 0 && errno != EINTR)
+        {
+            printf("poll 失败: %s\n", strerror(errno));
+            ret = -1;
+            break;
+        }
+        if (n <= 0)
+        {
+            continue;
+        }
+
+        if (handle_events(fd, pipe, dir, NULL) != 0)
+        {
+            ret = -1;
+            break;
+        }
+    }
+
+    printf("停止监视目录，等待在途图片处理完成...\n");
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    close(fd);
+    release_batch_pipeline(pipe);
+    return ret;
+}
@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "yolov6_pool.h"
+
+static const rknn_core_mask pool_core_masks[YOLOV6_POOL_NPU_CORES] = {
+    RKNN_NPU_CORE_0,
+    RKNN_NPU_CORE_1,
+    RKNN_NPU_CORE_2,
+};
+
+int init_yolov6_pool(const char *model_path, int size, yolov6_pool_t *pool)
+{
+    int ret;
+
+    memset(pool, 0, sizeof(yolov6_pool_t));
+    ret = init_yolov6_pool_scheduler(pool, size, 1);
+    if (ret != 0)
+    {
+        return -1;
+    }
+
+    ret = init_yolov6_model(model_path, &pool->app_ctx[0]);
+    if (ret != 0)
+    {
+        release_yolov6_pool(pool);
+        return -1;
+    }
+
+    // 只有一个上下文时保留三核协同，否则每个上下文独占一个核心
+    if (size > 1)
+    {
+        ret = rknn_set_core_mask(pool->app_ctx[0].rknn_ctx, pool_core_masks[0]);
+        if (ret != RKNN_SUCC)
+        {
+            printf("NPU核心掩码设置失败! ret=%d\n", ret);
+            release_yolov6_pool(pool);
+            return -1;
+        }
+        pool->app_ctx[0].core_mask = pool_core_masks[0];
+    }
+
+    for (int i = 1; i < size; i++)
+    {
+        rknn_core_mask core_mask = pool_core_masks[i % YOLOV6_POOL_NPU_CORES];
+        ret = dup_yolov6_model(&pool->app_ctx[0], &pool->app_ctx[i], core_mask);
+        if (ret != 0)
+        {
+            printf("创建第 %d 个上下文失败!\n", i);
+            release_yolov6_pool(pool);
+            return -1;
+        }
+    }
+    printf("上下文池初始化完成，共 %d 个上下文\n", size);
+    return 0;
+}
+
+int release_yolov6_pool(yolov6_pool_t *pool)
+{
+    if (pool == NULL || pool->size == 0)
+    {
+        return 0;
+    }
+    // 先释放复制出的上下文，最后释放持有模型的第一个上下文
+    for (int i = pool->size - 1; i >= 0; i--)
+    {
+        if (pool->app_ctx[i].rknn_ctx != 0)
+        {
+            release_yolov6_model(&pool->app_ctx[i]);
+        }
+    }
+    release_yolov6_pool_scheduler(pool);
+    return 0;
+}
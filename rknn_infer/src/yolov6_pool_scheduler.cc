@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "yolov6_pool.h"
+
+// 上下文池的调度部分，不调用 RKNN 接口，主机上可以和桩上下文一起单独编译测试
+
+int init_yolov6_pool_scheduler(yolov6_pool_t *pool, int size, int max_jobs)
+{
+    if (pool == NULL || size < 1 || size > YOLOV6_POOL_MAX_SIZE || max_jobs < 1)
+    {
+        printf("上下文池参数错误: size=%d max_jobs=%d\n", size, max_jobs);
+        return -1;
+    }
+    memset(pool->busy, 0, sizeof(pool->busy));
+    pool->size = size;
+    pool->max_jobs = max_jobs;
+    pool->next = 0;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+    return 0;
+}
+
+void release_yolov6_pool_scheduler(yolov6_pool_t *pool)
+{
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->cond);
+    pool->size = 0;
+}
+
+static int pick_least_busy(yolov6_pool_t *pool)
+{
+    int best = -1;
+    for (int n = 0; n < pool->size; n++)
+    {
+        int i = (pool->next + n) % pool->size;
+        if (pool->busy[i] >= pool->max_jobs)
+        {
+            continue;
+        }
+        if (best < 0 || pool->busy[i] < pool->busy[best])
+        {
+            best = i;
+        }
+    }
+    if (best >= 0)
+    {
+        pool->busy[best]++;
+        pool->next = (best + 1) % pool->size;
+    }
+    return best;
+}
+
+rknn_app_context_t *yolov6_pool_acquire(yolov6_pool_t *pool)
+{
+    int idx;
+    pthread_mutex_lock(&pool->lock);
+    while ((idx = pick_least_busy(pool)) < 0)
+    {
+        pthread_cond_wait(&pool->cond, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return &pool->app_ctx[idx];
+}
+
+rknn_app_context_t *yolov6_pool_try_acquire(yolov6_pool_t *pool)
+{
+    int idx;
+    pthread_mutex_lock(&pool->lock);
+    idx = pick_least_busy(pool);
+    pthread_mutex_unlock(&pool->lock);
+    return idx < 0 ? NULL : &pool->app_ctx[idx];
+}
+
+void yolov6_pool_release(yolov6_pool_t *pool, rknn_app_context_t *app_ctx)
+{
+    int idx = (int)(app_ctx - pool->app_ctx);
+    if (idx < 0 || idx >= pool->size)
+    {
+        printf("上下文不属于该池: %p\n", app_ctx);
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    if (pool->busy[idx] > 0)
+    {
+        pool->busy[idx]--;
+    }
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,62 @@
+// 主机测试用的 RGA 桩: 所有接口返回失败，image_utils 以 DISABLE_RGA 编译时全部走 CPU 路径
+#include <stdint.h>
+#include <string.h>
+
+#include "im2d.h"
+#include "image_rga_job.h"
+
+extern "C" {
+
+rga_buffer_handle_t importbuffer_fd(int, im_handle_param_t *)
+{
+    return 0;
+}
+
+rga_buffer_handle_t importbuffer_virtualaddr(void *, im_handle_param_t *)
+{
+    return 0;
+}
+
+rga_buffer_handle_t importbuffer_physicaladdr(uint64_t, im_handle_param_t *)
+{
+    return 0;
+}
+
+IM_STATUS releasebuffer_handle(rga_buffer_handle_t)
+{
+    return IM_STATUS_SUCCESS;
+}
+
+static rga_buffer_t empty_buffer()
+{
+    rga_buffer_t buffer;
+    memset(&buffer, 0, sizeof(buffer));
+    return buffer;
+}
+
+rga_buffer_t wrapbuffer_handle_t(rga_buffer_handle_t, int, int, int, int, int)
+{
+    return empty_buffer();
+}
+
+rga_buffer_t wrapbuffer_virtualaddr_t(void *, int, int, int, int, int)
+{
+    return empty_buffer();
+}
+
+rga_buffer_t wrapbuffer_fd_t(int, int, int, int, int, int)
+{
+    return empty_buffer();
+}
+
+rga_buffer_t wrapbuffer_physicaladdr_t(void *, int, int, int, int, int)
+{
+    return empty_buffer();
+}
+
+int run_rga_convert_job(rga_convert_task_t *, int)
+{
+    return -1;
+}
+
+}  // extern "C"
@@ -0,0 +1,18 @@
+#ifndef _RKNN_DEMO_TEST_COMMON_H_
+#define _RKNN_DEMO_TEST_COMMON_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// 主机测试用的最小断言，失败时打印位置并以非 0 退出，由 ctest 判定
+#define CHECK(cond)                                                         \
+    do                                                                      \
+    {                                                                       \
+        if (!(cond))                                                        \
+        {                                                                   \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                        \
+        }                                                                   \
+    } while (0)
+
+#endif //_RKNN_DEMO_TEST_COMMON_H_
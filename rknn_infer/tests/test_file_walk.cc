@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "file_utils.h"
+#include "test_common.h"
+
+static std::string root;
+
+static void touch(const char *name)
+{
+    std::string path = root + "/" + name;
+    FILE *fp = fopen(path.c_str(), "wb");
+    CHECK(fp != NULL);
+    fclose(fp);
+}
+
+static void make_dir(const char *name)
+{
+    CHECK(mkdir((root + "/" + name).c_str(), 0755) == 0);
+}
+
+typedef struct {
+    std::vector<std::string> paths;
+    int stop_after;     // 大于 0 时回调这么多次后要求停止
+} walk_result_t;
+
+static int collect(const char *path, void *user_data)
+{
+    walk_result_t *result = (walk_result_t *)user_data;
+    // 路径为 <root>/<相对路径>，只比较相对部分
+    CHECK(strncmp(path, root.c_str(), root.size()) == 0 && path[root.size()] == '/');
+    result->paths.push_back(path + root.size() + 1);
+    return result->stop_after > 0 && (int)result->paths.size() >= result->stop_after;
+}
+
+static std::vector<std::string> walk(const char *extensions, int flags, int expected_count)
+{
+    walk_result_t result;
+    result.stop_after = 0;
+    CHECK(walk_image_files(root.c_str(), extensions, flags, collect, &result) == expected_count);
+    CHECK((int)result.paths.size() == expected_count);
+    return result.paths;
+}
+
+static bool equals(const std::vector<std::string> &paths, const std::vector<std::string> &expected)
+{
+    return paths == expected;
+}
+
+int main()
+{
+    char dir[] = "/tmp/rknn_walk_test_XXXXXX";
+    CHECK(mkdtemp(dir) != NULL);
+    root = dir;
+
+    //   A.JPG b.jpg z.png n.txt link.jpg -> b.jpg  linkdir -> sub
+    //   sub/c.jpg sub/deep/d.png  .hidden/e.jpg
+    touch("b.jpg");
+    touch("A.JPG");
+    touch("z.png");
+    touch("n.txt");
+    make_dir("sub");
+    touch("sub/c.jpg");
+    make_dir("sub/deep");
+    touch("sub/deep/d.png");
+    make_dir(".hidden");
+    touch(".hidden/e.jpg");
+    CHECK(symlink("b.jpg", (root + "/link.jpg").c_str()) == 0);
+    CHECK(symlink("sub", (root + "/linkdir").c_str()) == 0);
+
+    // 有序递归: 每层按名字排序，子目录在自己的位置展开，跳过 . 开头的目录，不跟随目录链接
+    std::vector<std::string> sorted = walk(NULL, FILE_WALK_RECURSIVE | FILE_WALK_SORTED, 6);
+    CHECK(equals(sorted, {"A.JPG", "b.jpg", "link.jpg", "sub/c.jpg", "sub/deep/d.png", "z.png"}));
+
+    // 不排序时按目录顺序返回，内容相同
+    std::vector<std::string> unsorted = walk(NULL, FILE_WALK_RECURSIVE, 6);
+    std::sort(unsorted.begin(), unsorted.end());
+    std::vector<std::string> expected = sorted;
+    std::sort(expected.begin(), expected.end());
+    CHECK(equals(unsorted, expected));
+
+    // 不递归只看本层
+    CHECK(equals(walk(NULL, FILE_WALK_SORTED, 4), {"A.JPG", "b.jpg", "link.jpg", "z.png"}));
+
+    // 扩展名过滤不区分大小写
+    CHECK(equals(walk(".PNG", FILE_WALK_RECURSIVE | FILE_WALK_SORTED, 2), {"sub/deep/d.png", "z.png"}));
+    CHECK(equals(walk(".txt,.jpg", FILE_WALK_SORTED, 4), {"A.JPG", "b.jpg", "link.jpg", "n.txt"}));
+
+    // 回调返回非 0 时停止
+    walk_result_t stopped;
+    stopped.stop_after = 2;
+    CHECK(walk_image_files(root.c_str(), NULL, FILE_WALK_RECURSIVE | FILE_WALK_SORTED, collect, &stopped) == 2);
+    CHECK(equals(stopped.paths, {"A.JPG", "b.jpg"}));
+
+    // 根目录带结尾的 / 时不会出现 //
+    walk_result_t slash;
+    slash.stop_after = 0;
+    std::string root_slash = root + "/";
+    CHECK(walk_image_files(root_slash.c_str(), NULL, FILE_WALK_SORTED, collect, &slash) == 4);
+    CHECK(slash.paths[0] == "A.JPG");
+
+    walk_result_t missing;
+    missing.stop_after = 0;
+    CHECK(walk_image_files((root + "/none").c_str(), NULL, 0, collect, &missing) == -1);
+
+    // 旧接口一次列出本层的图片
+    int count = 0;
+    char **files = get_image_files_from_directory(root.c_str(), &count);
+    CHECK(files != NULL && count == 4);
+    free_file_list(files, count);
+
+    CHECK(system(("rm -rf " + root).c_str()) == 0);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "file_utils.h"
+#include "image_archive.h"
+#include "image_buffer_pool.h"
+#include "image_utils.h"
+#include "test_common.h"
+
+static uint32_t read_le32(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+int main()
+{
+    char dir[] = "/tmp/rknn_archive_test_XXXXXX";
+    CHECK(mkdtemp(dir) != NULL);
+    char jpg_path[256];
+    char archive_path[256];
+    snprintf(jpg_path, sizeof(jpg_path), "%s/a.jpg", dir);
+    snprintf(archive_path, sizeof(archive_path), "%s/t.rkpack", dir);
+
+    // 一个编码条目 + 一个 raw 条目
+    image_buffer_t image;
+    memset(&image, 0, sizeof(image_buffer_t));
+    image.width = 48;
+    image.height = 32;
+    image.format = IMAGE_FORMAT_RGB888;
+    CHECK(alloc_image_buffer(&image) == 0);
+    for (int i = 0; i < get_image_size(&image); i++)
+    {
+        image.virt_addr[i] = (unsigned char)(i * 13);
+    }
+    CHECK(write_image(jpg_path, &image) == 0);
+
+    image_archive_writer_t writer;
+    CHECK(create_image_archive(archive_path, &writer) == 0);
+    CHECK(image_archive_add_file(&writer, jpg_path, "sub/a.jpg") == 0);
+    CHECK(image_archive_add(&writer, "raw.rgb", image.virt_addr, get_image_size(&image), IMAGE_ARCHIVE_RAW,
+                            image.width, image.height, image.format, 3) == 0);
+    CHECK(finish_image_archive(&writer) == 0);
+    CHECK(is_image_archive(archive_path));
+    CHECK(!is_image_archive(jpg_path));
+
+    // 头部按小端存放，与主机字节序无关
+    char *bytes = NULL;
+    int file_size = read_data_from_file(archive_path, &bytes);
+    CHECK(file_size > (int)sizeof(image_archive_header_t));
+    CHECK(memcmp(bytes, IMAGE_ARCHIVE_MAGIC, 8) == 0);
+    CHECK(read_le32((const unsigned char *)bytes + 8) == IMAGE_ARCHIVE_VERSION);
+    CHECK(read_le32((const unsigned char *)bytes + 12) == 2);
+
+    image_archive_t archive;
+    CHECK(open_image_archive(archive_path, &archive) == 0);
+    CHECK(archive.count == 2);
+    CHECK(strcmp(get_image_archive_name(&archive, 0), "sub/a.jpg") == 0);
+    CHECK(strcmp(get_image_archive_name(&archive, 1), "raw.rgb") == 0);
+    CHECK(get_image_archive_name(&archive, 2) == NULL);
+    CHECK(archive.entries[0].type == IMAGE_ARCHIVE_ENCODED);
+    CHECK(archive.entries[0].width == 48 && archive.entries[0].height == 32 && archive.entries[0].format == -1);
+    CHECK(archive.entries[1].type == IMAGE_ARCHIVE_RAW);
+    CHECK(archive.entries[1].offset % IMAGE_ARCHIVE_ALIGN == 0);
+
+    // 编码条目与原文件内容一致
+    char *jpg_data = NULL;
+    int jpg_size = read_data_from_file(jpg_path, &jpg_data);
+    size_t size = 0;
+    const unsigned char *data = get_image_archive_data(&archive, 0, &size);
+    CHECK(data != NULL && (int)size == jpg_size && memcmp(data, jpg_data, size) == 0);
+
+    image_buffer_t decoded;
+    memset(&decoded, 0, sizeof(image_buffer_t));
+    CHECK(read_image_from_archive(&archive, 0, &decoded, 0, 0, 0) == 0);
+    CHECK(decoded.width == 48 && decoded.height == 32);
+    free_image_buffer(&decoded);
+
+    // raw 条目逐字节还原
+    memset(&decoded, 0, sizeof(image_buffer_t));
+    CHECK(read_image_from_archive(&archive, 1, &decoded, 0, 0, 0) == 0);
+    CHECK(decoded.width == 48 && decoded.height == 32 && decoded.format == IMAGE_FORMAT_RGB888);
+    sync_image_for_cpu(&decoded);
+    CHECK(memcmp(decoded.virt_addr, image.virt_addr, get_image_size(&image)) == 0);
+    free_image_buffer(&decoded);
+    close_image_archive(&archive);
+
+    // 截断的包（索引超出文件）被拒绝
+    CHECK(truncate(archive_path, file_size - 8) == 0);
+    CHECK(open_image_archive(archive_path, &archive) != 0);
+
+    free(bytes);
+    free(jpg_data);
+    free_image_buffer(&image);
+    release_image_buffer_pool();
+    unlink(jpg_path);
+    unlink(archive_path);
+    rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "image_resize.h"
+#include "test_common.h"
+
+// 定点实现之前的浮点双线性缩放 (crop_and_scale_image_c)，作为参考结果
+static void resize_float_reference(int channel, const unsigned char *src, int src_width, int src_height,
+                                   int crop_x, int crop_y, int crop_width, int crop_height,
+                                   unsigned char *dst, int dst_width, int dst_box_x, int dst_box_y,
+                                   int dst_box_width, int dst_box_height)
+{
+    float x_ratio = (float)crop_width / (float)dst_box_width;
+    float y_ratio = (float)crop_height / (float)dst_box_height;
+
+    for (int dst_y = dst_box_y; dst_y < dst_box_y + dst_box_height; dst_y++)
+    {
+        for (int dst_x = dst_box_x; dst_x < dst_box_x + dst_box_width; dst_x++)
+        {
+            int dst_x_offset = dst_x - dst_box_x;
+            int dst_y_offset = dst_y - dst_box_y;
+
+            int src_x = (int)(dst_x_offset * x_ratio) + crop_x;
+            int src_y = (int)(dst_y_offset * y_ratio) + crop_y;
+
+            float x_diff = (dst_x_offset * x_ratio) - (src_x - crop_x);
+            float y_diff = (dst_y_offset * y_ratio) - (src_y - crop_y);
+
+            int index1 = src_y * src_width * channel + src_x * channel;
+            int index2 = index1 + src_width * channel;
+            if (src_y == src_height - 1)
+            {
+                index2 = index1 - src_width * channel;
+            }
+            int index3 = index1 + channel;
+            int index4 = index2 + channel;
+            if (src_x == src_width - 1)
+            {
+                index3 = index1 - channel;
+                index4 = index2 - channel;
+            }
+
+            for (int c = 0; c < channel; c++)
+            {
+                unsigned char A = src[index1 + c];
+                unsigned char B = src[index3 + c];
+                unsigned char C = src[index2 + c];
+                unsigned char D = src[index4 + c];
+                dst[(dst_y * dst_width + dst_x) * channel + c] =
+                    (unsigned char)(A * (1 - x_diff) * (1 - y_diff) + B * x_diff * (1 - y_diff) +
+                                    C * y_diff * (1 - x_diff) + D * x_diff * y_diff);
+            }
+        }
+    }
+}
+
+static unsigned char *random_image(int size)
+{
+    unsigned char *image = (unsigned char *)malloc(size);
+    CHECK(image != NULL);
+    for (int i = 0; i < size; i++)
+    {
+        image[i] = (unsigned char)rand();
+    }
+    return image;
+}
+
+// 定点缩放与浮点参考最多差 1（随机尺寸、裁剪、目标区域和通道数）
+static void test_against_reference()
+{
+    for (int iter = 0; iter < 200; iter++)
+    {
+        int channel = rand() % 4 + 1;
+        int src_width = rand() % 300 + 2;
+        int src_height = rand() % 300 + 2;
+        int crop_x = rand() % (src_width / 2);
+        int crop_y = rand() % (src_height / 2);
+        int crop_width = rand() % (src_width - crop_x) + 1;
+        int crop_height = rand() % (src_height - crop_y) + 1;
+        int dst_width = rand() % 300 + 1;
+        int dst_height = rand() % 300 + 1;
+        int box_width = rand() % dst_width + 1;
+        int box_height = rand() % dst_height + 1;
+        int box_x = rand() % (dst_width - box_width + 1);
+        int box_y = rand() % (dst_height - box_height + 1);
+
+        int dst_size = dst_width * dst_height * channel;
+        unsigned char *src = random_image(src_width * src_height * channel);
+        unsigned char *expected = (unsigned char *)calloc(dst_size, 1);
+        unsigned char *actual = (unsigned char *)calloc(dst_size, 1);
+        resize_float_reference(channel, src, src_width, src_height, crop_x, crop_y, crop_width, crop_height,
+                               expected, dst_width, box_x, box_y, box_width, box_height);
+        // 第二次调用走缓存的系数
+        for (int rep = 0; rep < 2; rep++)
+        {
+            CHECK(resize_bilinear(channel, src, src_width, src_height, src_width * channel, crop_x, crop_y,
+                                  crop_width, crop_height, actual, dst_width, dst_height, dst_width * channel,
+                                  box_x, box_y, box_width, box_height) == 0);
+        }
+        for (int i = 0; i < dst_size; i++)
+        {
+            CHECK(abs(expected[i] - actual[i]) <= 1);
+        }
+        free(src);
+        free(expected);
+        free(actual);
+    }
+}
+
+// 灰度到 RGB 与单通道缩放后复制三份一致
+static void test_gray_to_rgb()
+{
+    int src_width = 333, src_height = 517, dst_width = 320, dst_height = 320;
+    unsigned char *src = random_image(src_width * src_height);
+    unsigned char *gray = (unsigned char *)calloc(dst_width * dst_height, 1);
+    unsigned char *rgb = (unsigned char *)calloc(dst_width * dst_height * 3, 1);
+    CHECK(resize_bilinear(1, src, src_width, src_height, src_width, 0, 0, src_width, src_height, gray, dst_width,
+                          dst_height, dst_width, 56, 0, 206, 320) == 0);
+    CHECK(resize_bilinear_gray_to_rgb(src, src_width, src_height, src_width, 0, 0, src_width, src_height, rgb,
+                                      dst_width, dst_height, dst_width * 3, 56, 0, 206, 320) == 0);
+    for (int i = 0; i < dst_width * dst_height; i++)
+    {
+        CHECK(rgb[i * 3] == gray[i] && rgb[i * 3 + 1] == gray[i] && rgb[i * 3 + 2] == gray[i]);
+    }
+    free(src);
+    free(gray);
+    free(rgb);
+}
+
+// 分带多线程缩放与单线程结果逐字节一致
+static void test_threads()
+{
+    int src_width = 1280, src_height = 720, dst_width = 640, dst_height = 640;
+    int dst_size = dst_width * dst_height * 3;
+    unsigned char *src = random_image(src_width * src_height * 3);
+    unsigned char *single = (unsigned char *)calloc(dst_size, 1);
+    unsigned char *banded = (unsigned char *)calloc(dst_size, 1);
+    CHECK(resize_init_threads(1, NULL) == 0);
+    CHECK(resize_bilinear(3, src, src_width, src_height, src_width * 3, 0, 0, src_width, src_height, single,
+                          dst_width, dst_height, dst_width * 3, 0, 140, 640, 360) == 0);
+    CHECK(resize_init_threads(4, NULL) == 0);
+    CHECK(resize_bilinear(3, src, src_width, src_height, src_width * 3, 0, 0, src_width, src_height, banded,
+                          dst_width, dst_height, dst_width * 3, 0, 140, 640, 360) == 0);
+    resize_deinit_threads();
+    CHECK(memcmp(single, banded, dst_size) == 0);
+    free(src);
+    free(single);
+    free(banded);
+}
+
+static int clamp_u8(int v)
+{
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+// 1:1 缩放、色度恒定时 NV12/NV21/YUYV 的输出与逐像素 BT.601 (Q10) 转换完全一致
+static void test_yuv_to_rgb()
+{
+    const int width = 100, height = 20;
+    unsigned char nv[100 * 30];
+    unsigned char yuyv[200 * 20];
+    unsigned char rgb[100 * 20 * 3];
+
+    for (int u = 0; u < 256; u += 51)
+    {
+        for (int v = 0; v < 256; v += 51)
+        {
+            for (int i = 0; i < width * height; i++)
+            {
+                nv[i] = (unsigned char)(i * 13);
+                yuyv[i * 2] = nv[i];
+                yuyv[i * 2 + 1] = (unsigned char)((i & 1) ? v : u);
+            }
+            for (int layout = RESIZE_YUV_NV12; layout <= RESIZE_YUV_YUYV; layout++)
+            {
+                for (int i = 0; i < width * height / 2; i += 2)
+                {
+                    nv[width * height + i] = (unsigned char)(layout == RESIZE_YUV_NV21 ? v : u);
+                    nv[width * height + i + 1] = (unsigned char)(layout == RESIZE_YUV_NV21 ? u : v);
+                }
+                int pitch = layout == RESIZE_YUV_YUYV ? width * 2 : width;
+                CHECK(resize_yuv_to_rgb(layout, layout == RESIZE_YUV_YUYV ? yuyv : nv, nv + width * height, width,
+                                        height, pitch, 0, 0, width, height, rgb, width, height, width * 3, 0, 0,
+                                        width, height) == 0);
+                for (int i = 0; i < width * height; i++)
+                {
+                    int c = (nv[i] - 16) * 1192 + 512;
+                    int d = u - 128;
+                    int e = v - 128;
+                    CHECK(rgb[i * 3] == clamp_u8((c + 1634 * e) >> 10));
+                    CHECK(rgb[i * 3 + 1] == clamp_u8((c - 401 * d - 833 * e) >> 10));
+                    CHECK(rgb[i * 3 + 2] == clamp_u8((c + 2066 * d) >> 10));
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    srand(7);
+    test_against_reference();
+    test_gray_to_rgb();
+    test_threads();
+    test_yuv_to_rgb();
+    return 0;
+}
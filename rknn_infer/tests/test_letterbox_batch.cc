@@ -0,0 +1,78 @@
+#include <string.h>
+
+#include "image_buffer_pool.h"
+#include "image_utils.h"
+#include "test_common.h"
+
+#define TEST_IMAGE_COUNT 4
+
+static const int src_sizes[TEST_IMAGE_COUNT][2] = {{640, 480}, {333, 517}, {1280, 720}, {64, 64}};
+
+static void fill_pattern(image_buffer_t *image, int seed)
+{
+    int size = get_image_size(image);
+    for (int i = 0; i < size; i++)
+    {
+        image->virt_addr[i] = (unsigned char)(i * 7 + seed * 31 + (i >> 9));
+    }
+}
+
+static void alloc_dst(image_buffer_t *image)
+{
+    memset(image, 0, sizeof(image_buffer_t));
+    image->width = 640;
+    image->height = 640;
+    image->format = IMAGE_FORMAT_RGB888;
+    CHECK(alloc_image_buffer(image) == 0);
+}
+
+int main()
+{
+    image_buffer_t src[TEST_IMAGE_COUNT];
+    image_buffer_t batch_dst[TEST_IMAGE_COUNT];
+    image_buffer_t single_dst[TEST_IMAGE_COUNT];
+    image_buffer_t *src_ptrs[TEST_IMAGE_COUNT];
+    image_buffer_t *dst_ptrs[TEST_IMAGE_COUNT];
+    letterbox_t batch_boxes[TEST_IMAGE_COUNT];
+
+    for (int i = 0; i < TEST_IMAGE_COUNT; i++)
+    {
+        memset(&src[i], 0, sizeof(image_buffer_t));
+        src[i].width = src_sizes[i][0];
+        src[i].height = src_sizes[i][1];
+        src[i].format = IMAGE_FORMAT_RGB888;
+        CHECK(alloc_image_buffer(&src[i]) == 0);
+        fill_pattern(&src[i], i);
+        alloc_dst(&batch_dst[i]);
+        alloc_dst(&single_dst[i]);
+        src_ptrs[i] = &src[i];
+        dst_ptrs[i] = &batch_dst[i];
+    }
+
+    // 数量越界
+    CHECK(convert_image_with_letterbox_batch(src_ptrs, dst_ptrs, batch_boxes, 0, 114) != 0);
+    CHECK(convert_image_with_letterbox_batch(src_ptrs, dst_ptrs, batch_boxes, IMAGE_CONVERT_BATCH_MAX + 1, 114) != 0);
+
+    // 批量结果与逐帧 letterbox 逐字节一致
+    CHECK(convert_image_with_letterbox_batch(src_ptrs, dst_ptrs, batch_boxes, TEST_IMAGE_COUNT, 114) == 0);
+    for (int i = 0; i < TEST_IMAGE_COUNT; i++)
+    {
+        letterbox_t single_box;
+        CHECK(convert_image_with_letterbox(&src[i], &single_dst[i], &single_box, 114) == 0);
+        CHECK(batch_boxes[i].x_pad == single_box.x_pad);
+        CHECK(batch_boxes[i].y_pad == single_box.y_pad);
+        CHECK(batch_boxes[i].scale == single_box.scale);
+        sync_image_for_cpu(&batch_dst[i]);
+        sync_image_for_cpu(&single_dst[i]);
+        CHECK(memcmp(batch_dst[i].virt_addr, single_dst[i].virt_addr, get_image_size(&batch_dst[i])) == 0);
+    }
+
+    for (int i = 0; i < TEST_IMAGE_COUNT; i++)
+    {
+        free_image_buffer(&src[i]);
+        free_image_buffer(&batch_dst[i]);
+        free_image_buffer(&single_dst[i]);
+    }
+    release_image_buffer_pool();
+    return 0;
+}
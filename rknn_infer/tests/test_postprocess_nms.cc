@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "postprocess.h"
+#include "test_common.h"
+#include "yolov6.h"
+
+#define TEST_CLASSES 6
+#define TEST_BRANCHES 3
+#define TEST_MODEL_SIZE 640
+
+typedef struct {
+    float x1, y1, x2, y2;
+    float score;
+    int cls;
+} candidate_t;
+
+// 改为 top-K + 按类别分桶 + 网格之前的 NMS: 全部候选按分数排序，两两比较同类别的 IoU
+static float reference_overlap(const candidate_t &a, const candidate_t &b)
+{
+    float w = fmax(0.f, fmin(a.x2, b.x2) - fmax(a.x1, b.x1) + 1.0);
+    float h = fmax(0.f, fmin(a.y2, b.y2) - fmax(a.y1, b.y1) + 1.0);
+    float i = w * h;
+    float u = (a.x2 - a.x1 + 1.0) * (a.y2 - a.y1 + 1.0) + (b.x2 - b.x1 + 1.0) * (b.y2 - b.y1 + 1.0) - i;
+    return u <= 0.f ? 0.f : (i / u);
+}
+
+static std::vector<candidate_t> reference_nms(std::vector<candidate_t> candidates, float threshold)
+{
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const candidate_t &a, const candidate_t &b) { return a.score > b.score; });
+    // 进入 NMS 的候选数有上限，只保留分数最高的
+    if ((int)candidates.size() > NMS_MAX_CANDIDATES)
+    {
+        candidates.resize(NMS_MAX_CANDIDATES);
+    }
+    std::vector<char> removed(candidates.size(), 0);
+    std::vector<candidate_t> kept;
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        if (removed[i])
+        {
+            continue;
+        }
+        kept.push_back(candidates[i]);
+        for (size_t j = i + 1; j < candidates.size(); j++)
+        {
+            if (!removed[j] && candidates[j].cls == candidates[i].cls &&
+                reference_overlap(candidates[i], candidates[j]) > threshold)
+            {
+                removed[j] = 1;
+            }
+        }
+    }
+    return kept;
+}
+
+static float clamp_coord(float v)
+{
+    return v < 0 ? 0 : (v > TEST_MODEL_SIZE ? TEST_MODEL_SIZE : v);
+}
+
+// 浮点模型、每个分支 box (4 通道 ltrb) + score 两个 NCHW 输出。
+// 候选集中在少数几簇，单个类别的候选超过 NMS_GRID_MIN_BOXES，走网格路径
+static void run_case(int clusters, int per_cluster, unsigned int seed)
+{
+    srand(seed);
+    rknn_app_context_t app_ctx;
+    memset(&app_ctx, 0, sizeof(rknn_app_context_t));
+    rknn_tensor_attr attrs[TEST_BRANCHES * 2];
+    rknn_output outputs[TEST_BRANCHES * 2];
+    memset(attrs, 0, sizeof(attrs));
+    memset(outputs, 0, sizeof(outputs));
+    app_ctx.io_num.n_output = TEST_BRANCHES * 2;
+    app_ctx.model_width = TEST_MODEL_SIZE;
+    app_ctx.model_height = TEST_MODEL_SIZE;
+    app_ctx.output_attrs = attrs;
+
+    int grids[TEST_BRANCHES];
+    for (int b = 0; b < TEST_BRANCHES; b++)
+    {
+        grids[b] = TEST_MODEL_SIZE / (8 << b);
+        for (int k = 0; k < 2; k++)
+        {
+            rknn_tensor_attr *attr = &attrs[b * 2 + k];
+            attr->fmt = RKNN_TENSOR_NCHW;
+            attr->type = RKNN_TENSOR_FLOAT32;
+            attr->n_dims = 4;
+            attr->dims[0] = 1;
+            attr->dims[1] = k == 0 ? 4 : TEST_CLASSES;
+            attr->dims[2] = grids[b];
+            attr->dims[3] = grids[b];
+            outputs[b * 2 + k].buf = calloc(attr->dims[1] * grids[b] * grids[b], sizeof(float));
+        }
+    }
+
+    // 分数互不相同，排序结果唯一
+    std::vector<candidate_t> candidates;
+    int total = clusters * per_cluster;
+    std::vector<int> ranks(total);
+    for (int i = 0; i < total; i++)
+    {
+        ranks[i] = i;
+    }
+    std::random_shuffle(ranks.begin(), ranks.end(), [](int n) { return rand() % n; });
+    for (int c = 0; c < clusters; c++)
+    {
+        int b = rand() % TEST_BRANCHES;
+        int grid = grids[b];
+        int stride = TEST_MODEL_SIZE / grid;
+        int cls = rand() % TEST_CLASSES;
+        int cx = rand() % grid;
+        int cy = rand() % grid;
+        float *box = (float *)outputs[b * 2].buf;
+        float *score = (float *)outputs[b * 2 + 1].buf;
+        for (int n = 0; n < per_cluster; n++)
+        {
+            int i = cy + rand() % 9 - 4;
+            int j = cx + rand() % 9 - 4;
+            i = i < 0 ? 0 : (i >= grid ? grid - 1 : i);
+            j = j < 0 ? 0 : (j >= grid ? grid - 1 : j);
+            int cell = i * grid + j;
+            bool used = false;
+            for (int k = 0; k < TEST_CLASSES; k++)
+            {
+                used = used || score[k * grid * grid + cell] > 0;
+            }
+            if (used)
+            {
+                continue;
+            }
+            candidate_t cand;
+            float ltrb[4];
+            for (int k = 0; k < 4; k++)
+            {
+                ltrb[k] = 0.5f + (rand() % 40) * 0.1f;
+                box[k * grid * grid + cell] = ltrb[k];
+            }
+            cand.score = 0.26f + ranks[c * per_cluster + n] * (0.7f / total);
+            cand.cls = cls;
+            score[cls * grid * grid + cell] = cand.score;
+            // 其他类别给低于阈值的分数
+            score[((cls + 1) % TEST_CLASSES) * grid * grid + cell] = 0.1f;
+            cand.x1 = (-ltrb[0] + j + 0.5) * stride;
+            cand.y1 = (-ltrb[1] + i + 0.5) * stride;
+            cand.x2 = (ltrb[2] + j + 0.5) * stride;
+            cand.y2 = (ltrb[3] + i + 0.5) * stride;
+            candidates.push_back(cand);
+        }
+    }
+
+    CHECK(init_post_process_buf(&app_ctx) == 0);
+    letterbox_t letter_box;
+    memset(&letter_box, 0, sizeof(letterbox_t));
+    letter_box.scale = 1.0f;
+    object_detect_result_list results;
+    CHECK(post_process(&app_ctx, outputs, &letter_box, 0.25f, NMS_THRESH, &results) == 0);
+
+    std::vector<candidate_t> expected = reference_nms(candidates, NMS_THRESH);
+    int expected_count = expected.size() > OBJ_NUMB_MAX_SIZE ? OBJ_NUMB_MAX_SIZE : (int)expected.size();
+    CHECK(expected_count > 0 && expected.size() < candidates.size());
+    CHECK(results.count == expected_count);
+    for (int i = 0; i < expected_count; i++)
+    {
+        const object_detect_result *r = &results.results[i];
+        CHECK(r->cls_id == expected[i].cls);
+        CHECK(r->prop == expected[i].score);
+        CHECK(r->box.left == (int)clamp_coord(expected[i].x1));
+        CHECK(r->box.top == (int)clamp_coord(expected[i].y1));
+        CHECK(r->box.right == (int)clamp_coord(expected[i].x2));
+        CHECK(r->box.bottom == (int)clamp_coord(expected[i].y2));
+    }
+
+    release_post_process_buf(&app_ctx);
+    for (int i = 0; i < TEST_BRANCHES * 2; i++)
+    {
+        free(outputs[i].buf);
+    }
+}
+
+int main()
+{
+    // 候选不到 NMS_MAX_CANDIDATES，结果与原 O(n^2) NMS 完全相同
+    run_case(8, 90, 1);
+    run_case(20, 40, 2);
+    // 候选超过上限，只有分数最高的 NMS_MAX_CANDIDATES 个参与 NMS
+    run_case(40, 80, 3);
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <string.h>
+#include <string>
+#include <unistd.h>
+
+#include "file_utils.h"
+#include "result_sink.h"
+#include "test_common.h"
+
+// 没有调用 init_post_process，类别名为 "null"
+static object_detect_result_list detections;
+static object_detect_result_list empty;
+
+static void write_results(const char *path, int format)
+{
+    result_sink_t sink;
+    CHECK(open_result_sink(path, format, &sink) == 0);
+    CHECK(result_sink_write(&sink, 0, "/data/a,\"b\".jpg", 640, 480, &detections) == 0);
+    CHECK(result_sink_write(&sink, 1, "c\\d\n.jpg", 320, 240, &empty) == 0);
+    CHECK(result_sink_write(&sink, 2, "bad.jpg", 0, 0, NULL) == 0);
+    CHECK(sink.count == 3);
+    CHECK(close_result_sink(&sink) == 0);
+}
+
+static std::string read_file(const char *path)
+{
+    char *data = NULL;
+    int size = read_data_from_file(path, &data);
+    CHECK(size > 0);
+    std::string content(data, size);
+    free(data);
+    return content;
+}
+
+int main()
+{
+    memset(&detections, 0, sizeof(detections));
+    memset(&empty, 0, sizeof(empty));
+    detections.count = 2;
+    detections.results[0].box.left = 1;
+    detections.results[0].box.top = 2;
+    detections.results[0].box.right = 3;
+    detections.results[0].box.bottom = 4;
+    detections.results[0].prop = 0.9f;
+    detections.results[0].cls_id = 0;
+    detections.results[1].box.left = 5;
+    detections.results[1].box.top = 6;
+    detections.results[1].box.right = 7;
+    detections.results[1].box.bottom = 8;
+    detections.results[1].prop = 0.55f;
+    detections.results[1].cls_id = 3;
+
+    CHECK(parse_result_sink_format(NULL, "out/results.jsonl") == RESULT_SINK_JSONL);
+    CHECK(parse_result_sink_format(NULL, "results.CSV") == RESULT_SINK_CSV);
+    CHECK(parse_result_sink_format(NULL, "results") == RESULT_SINK_JSONL);
+    CHECK(parse_result_sink_format("bin", "results.csv") == RESULT_SINK_BINARY);
+    CHECK(parse_result_sink_format("xml", NULL) == -1);
+
+    char dir[] = "/tmp/rknn_sink_test_XXXXXX";
+    CHECK(mkdtemp(dir) != NULL);
+    std::string jsonl_path = std::string(dir) + "/r.jsonl";
+    std::string csv_path = std::string(dir) + "/r.csv";
+    std::string bin_path = std::string(dir) + "/r.bin";
+
+    // JSON 字符串转义引号、反斜杠和控制字符
+    write_results(jsonl_path.c_str(), RESULT_SINK_JSONL);
+    CHECK(read_file(jsonl_path.c_str()) ==
+          "{\"image_id\":0,\"path\":\"/data/a,\\\"b\\\".jpg\",\"width\":640,\"height\":480,\"status\":\"ok\","
+          "\"objects\":[{\"cls_id\":0,\"class\":\"null\",\"prop\":0.9000,\"box\":[1,2,3,4]},"
+          "{\"cls_id\":3,\"class\":\"null\",\"prop\":0.5500,\"box\":[5,6,7,8]}]}\n"
+          "{\"image_id\":1,\"path\":\"c\\\\d\\u000a.jpg\",\"width\":320,\"height\":240,\"status\":\"ok\","
+          "\"objects\":[]}\n"
+          "{\"image_id\":2,\"path\":\"bad.jpg\",\"status\":\"failed\"}\n");
+
+    // CSV 每个检测框一行，含逗号、引号、换行的字段加引号
+    write_results(csv_path.c_str(), RESULT_SINK_CSV);
+    CHECK(read_file(csv_path.c_str()) ==
+          "image_id,path,width,height,status,cls_id,class,prop,left,top,right,bottom\n"
+          "0,\"/data/a,\"\"b\"\".jpg\",640,480,ok,0,null,0.9000,1,2,3,4\n"
+          "0,\"/data/a,\"\"b\"\".jpg\",640,480,ok,3,null,0.5500,5,6,7,8\n"
+          "1,\"c\\d\n.jpg\",320,240,ok,,,,,,,\n"
+          "2,bad.jpg,,,failed,,,,,,,\n");
+
+    // 二进制: 文件头 + 每张图片的记录头和检测框
+    write_results(bin_path.c_str(), RESULT_SINK_BINARY);
+    std::string bin = read_file(bin_path.c_str());
+    const size_t record_size = sizeof(result_record_header_t);
+    CHECK(bin.size() == sizeof(result_file_header_t) + 3 * record_size + 2 * sizeof(object_detect_result));
+    result_file_header_t header;
+    memcpy(&header, bin.data(), sizeof(header));
+    CHECK(header.magic == RESULT_BINARY_MAGIC && header.version == RESULT_BINARY_VERSION);
+    CHECK(header.record_size == sizeof(object_detect_result));
+    size_t offset = sizeof(header);
+    result_record_header_t record;
+    memcpy(&record, bin.data() + offset, record_size);
+    CHECK(record.image_id == 0 && record.width == 640 && record.height == 480 && record.count == 2);
+    offset += record_size;
+    object_detect_result det;
+    memcpy(&det, bin.data() + offset + sizeof(det), sizeof(det));
+    CHECK(det.cls_id == 3 && det.prop == 0.55f && det.box.bottom == 8);
+    offset += 2 * sizeof(det);
+    memcpy(&record, bin.data() + offset, record_size);
+    CHECK(record.image_id == 1 && record.count == 0);
+    offset += record_size;
+    memcpy(&record, bin.data() + offset, record_size);
+    CHECK(record.image_id == 2 && record.count == -1);
+
+    CHECK(unlink(jsonl_path.c_str()) == 0 && unlink(csv_path.c_str()) == 0 && unlink(bin_path.c_str()) == 0);
+    rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test_common.h"
+#include "yolov6_pool.h"
+
+// 桩上下文: 只初始化调度状态，app_ctx 保持全 0，调度不会访问其中的 RKNN 句柄
+static yolov6_pool_t pool;
+
+static int index_of(rknn_app_context_t *app_ctx)
+{
+    return app_ctx == NULL ? -1 : (int)(app_ctx - pool.app_ctx);
+}
+
+static volatile int blocked_done;
+
+static void *blocked_acquire(void *arg)
+{
+    rknn_app_context_t **out = (rknn_app_context_t **)arg;
+    *out = yolov6_pool_acquire(&pool);
+    __sync_synchronize();
+    blocked_done = 1;
+    return NULL;
+}
+
+int main()
+{
+    memset(&pool, 0, sizeof(pool));
+    CHECK(init_yolov6_pool_scheduler(&pool, 0, 1) != 0);
+    CHECK(init_yolov6_pool_scheduler(&pool, YOLOV6_POOL_MAX_SIZE + 1, 1) != 0);
+    CHECK(init_yolov6_pool_scheduler(&pool, 3, 2) == 0);
+
+    // 负载相同时轮流分配
+    CHECK(index_of(yolov6_pool_acquire(&pool)) == 0);
+    CHECK(index_of(yolov6_pool_acquire(&pool)) == 1);
+    CHECK(index_of(yolov6_pool_acquire(&pool)) == 2);
+    CHECK(index_of(yolov6_pool_acquire(&pool)) == 0);
+
+    // 负载 2,1,1 -> 释放 1 后负载 2,0,1，选最空闲的 1
+    yolov6_pool_release(&pool, &pool.app_ctx[1]);
+    CHECK(index_of(yolov6_pool_acquire(&pool)) == 1);
+
+    // 负载 2,1,1 -> 2,1,2 -> 2,2,2，满载后非阻塞版本返回 NULL
+    CHECK(index_of(yolov6_pool_try_acquire(&pool)) == 2);
+    CHECK(index_of(yolov6_pool_try_acquire(&pool)) == 1);
+    CHECK(yolov6_pool_try_acquire(&pool) == NULL);
+
+    // 满载时 acquire 阻塞，直到有上下文被释放
+    rknn_app_context_t *got = NULL;
+    pthread_t thread;
+    blocked_done = 0;
+    CHECK(pthread_create(&thread, NULL, blocked_acquire, &got) == 0);
+    usleep(100 * 1000);
+    CHECK(!blocked_done);
+    yolov6_pool_release(&pool, &pool.app_ctx[2]);
+    pthread_join(thread, NULL);
+    CHECK(blocked_done && index_of(got) == 2);
+
+    // 不属于该池的上下文被忽略
+    rknn_app_context_t other;
+    yolov6_pool_release(&pool, &other);
+    CHECK(yolov6_pool_try_acquire(&pool) == NULL);
+
+    release_yolov6_pool_scheduler(&pool);
+    CHECK(pool.size == 0);
+    printf("yolov6_pool: ok\n");
+    return 0;
+}
@@ -11,6 +11,7 @@ typedef enum {
     IMAGE_FORMAT_RGBA8888,
     IMAGE_FORMAT_YUV420SP_NV21,
     IMAGE_FORMAT_YUV420SP_NV12,
+    IMAGE_FORMAT_YUYV422,
 } image_format_t;
 
 /**
@@ -20,12 +21,14 @@ typedef enum {
 typedef struct {
     int width;
     int height;
-    int width_stride;
-    int height_stride;
+    int width_stride;   // pixels between rows, 0: same as width
+    int height_stride;  // rows between planes, 0: same as height
     image_format_t format;
     unsigned char* virt_addr;
     int size;
     int fd;
+    int orig_width;     // size before decode-time downscaling, 0: same as width
+    int orig_height;    // 0: same as height
 } image_buffer_t;
 
 /**
@@ -1,10 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <limits.h>
 #include <dirent.h>
+#include <errno.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include "file_utils.h"
+
 #define MAX_TEXT_LINE_LENGTH 1024
 
 unsigned char* load_model(const char* filename, int* model_size)
@@ -131,6 +136,33 @@ void free_lines(char** lines, int line_count)
     free(lines);
 }
 
+int make_directories(const char* path)
+{
+    char buf[PATH_MAX];
+    size_t len = strlen(path);
+    if (len == 0 || len >= sizeof(buf)) {
+        return -1;
+    }
+    memcpy(buf, path, len + 1);
+    // 逐级创建，已存在的（包括其他线程刚创建的）跳过
+    for (char* p = buf + 1; ; p++) {
+        if (*p != '/' && *p != '\0') {
+            continue;
+        }
+        char c = *p;
+        *p = '\0';
+        if (mkdir(buf, 0755) != 0 && errno != EEXIST) {
+            printf("mkdir %s fail\n", buf);
+            return -1;
+        }
+        if (c == '\0') {
+            break;
+        }
+        *p = c;
+    }
+    return 0;
+}
+
 int is_image_file(const char* filename)
 {
     if (!filename) return 0;
@@ -151,78 +183,233 @@ int is_image_file(const char* filename)
     return 0;
 }
 
-char** get_image_files_from_directory(const char* directory_path, int* file_count)
+// 扩展名列表为逗号分隔，如 ".jpg,.png"，不区分大小写
+static int match_extension(const char* name, const char* extensions)
 {
-    DIR* dir;
-    struct dirent* entry;
-    char** image_files = NULL;
-    int count = 0;
-    int capacity = 10;
+    if (extensions == NULL) {
+        return is_image_file(name);
+    }
+    const char* ext = strrchr(name, '.');
+    if (ext == NULL) {
+        return 0;
+    }
+    size_t ext_len = strlen(ext);
+    const char* p = extensions;
+    while (*p != '\0') {
+        const char* end = strchr(p, ',');
+        size_t len = end != NULL ? (size_t)(end - p) : strlen(p);
+        if (len == ext_len && strncasecmp(ext, p, len) == 0) {
+            return 1;
+        }
+        if (end == NULL) {
+            break;
+        }
+        p = end + 1;
+    }
+    return 0;
+}
 
-    *file_count = 0;
+typedef struct {
+    const char* extensions;
+    int flags;
+    file_walk_callback callback;
+    void* user_data;
+    int count;
+    int stop;
+} file_walk_t;
+
+static int compare_names(const void* a, const void* b)
+{
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+// d_type 为 DT_UNKNOWN（部分文件系统）或符号链接时才 stat
+static int get_entry_type(const char* path, unsigned char d_type)
+{
+    if (d_type == DT_REG || d_type == DT_DIR) {
+        return d_type;
+    }
+    struct stat st;
+    if (d_type == DT_LNK) {
+        // 跟随指向文件的链接，不进入链接的目录，避免循环
+        return stat(path, &st) == 0 && S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+    }
+    if (d_type == DT_UNKNOWN && lstat(path, &st) == 0) {
+        if (S_ISREG(st.st_mode)) return DT_REG;
+        if (S_ISDIR(st.st_mode)) return DT_DIR;
+    }
+    return DT_UNKNOWN;
+}
 
-    dir = opendir(directory_path);
+static void walk_entry(file_walk_t* walk, char* path, size_t dir_len, const char* name, unsigned char d_type);
+
+// path 是 PATH_MAX 大小的缓冲区，子项的路径直接拼接在后面
+static void walk_directory(file_walk_t* walk, char* path)
+{
+    DIR* dir = opendir(path);
     if (dir == NULL) {
-        printf("无法打开目录: %s\n", directory_path);
-        return NULL;
+        printf("无法打开目录: %s\n", path);
+        return;
     }
+    size_t dir_len = strlen(path);
 
-    // 分配初始内存
-    image_files = (char**)malloc(capacity * sizeof(char*));
-    if (image_files == NULL) {
-        printf("内存分配失败\n");
+    if (!(walk->flags & FILE_WALK_SORTED)) {
+        // 边读目录边回调，第一个文件不用等整个目录扫描完
+        struct dirent* entry;
+        while (!walk->stop && (entry = readdir(dir)) != NULL) {
+            walk_entry(walk, path, dir_len, entry->d_name, entry->d_type);
+        }
         closedir(dir);
-        return NULL;
+        path[dir_len] = '\0';
+        return;
     }
 
+    // 有序遍历: 先收集本层的名字排序，再逐个处理（子目录在各自的位置上展开）
+    char** names = NULL;
+    int count = 0;
+    int capacity = 0;
+    struct dirent* entry;
     while ((entry = readdir(dir)) != NULL) {
-        // 跳过 . 和 .. 目录
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
+        if (count >= capacity) {
+            capacity = capacity > 0 ? capacity * 2 : 64;
+            char** new_names = (char**)realloc(names, capacity * sizeof(char*));
+            if (new_names == NULL) {
+                printf("内存重新分配失败\n");
+                break;
+            }
+            names = new_names;
         }
+        // 名字后面多存一个字节放 d_type，排序后仍然对应
+        size_t len = strlen(entry->d_name);
+        names[count] = (char*)malloc(len + 2);
+        if (names[count] == NULL) {
+            printf("内存分配失败\n");
+            break;
+        }
+        memcpy(names[count], entry->d_name, len + 1);
+        names[count][len + 1] = (char)entry->d_type;
+        count++;
+    }
+    closedir(dir);
 
-        // 检查是否是图片文件
-        if (is_image_file(entry->d_name)) {
-            // 构建完整路径
-            char full_path[1024];
-            int path_length = snprintf(full_path, sizeof(full_path), "%s/%s", directory_path, entry->d_name);
+    qsort(names, count, sizeof(char*), compare_names);
+    for (int i = 0; i < count; i++) {
+        if (!walk->stop) {
+            walk_entry(walk, path, dir_len, names[i], (unsigned char)names[i][strlen(names[i]) + 1]);
+        }
+        free(names[i]);
+    }
+    free(names);
+    path[dir_len] = '\0';
+}
 
-            if (path_length >= sizeof(full_path)) {
-                printf("路径过长: %s/%s\n", directory_path, entry->d_name);
-                continue;
-            }
+static void walk_entry(file_walk_t* walk, char* path, size_t dir_len, const char* name, unsigned char d_type)
+{
+    if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+        return;
+    }
+    int is_dir_candidate = (walk->flags & FILE_WALK_RECURSIVE) && name[0] != '.';
+    if (!is_dir_candidate && !match_extension(name, walk->extensions)) {
+        // 不递归时只需要看扩展名，不匹配的不用判断类型
+        return;
+    }
 
-            // 检查是否是普通文件
-            struct stat file_stat;
-            if (stat(full_path, &file_stat) == 0 && S_ISREG(file_stat.st_mode)) {
-                // 如果容量不足，扩展数组
-                if (count >= capacity) {
-                    capacity *= 2;
-                    char** temp = (char**)realloc(image_files, capacity * sizeof(char*));
-                    if (temp == NULL) {
-                        printf("内存重新分配失败\n");
-                        break;
-                    }
-                    image_files = temp;
-                }
-
-                // 分配内存并复制路径
-                image_files[count] = (char*)malloc(strlen(full_path) + 1);
-                if (image_files[count] == NULL) {
-                    printf("内存分配失败\n");
-                    break;
-                }
-
-                strcpy(image_files[count], full_path);
-                count++;
-            }
+    size_t name_len = strlen(name);
+    int sep = dir_len > 0 && path[dir_len - 1] != '/';
+    if (dir_len + sep + name_len >= PATH_MAX) {
+        printf("路径过长: %s/%s\n", path, name);
+        return;
+    }
+    if (sep) {
+        path[dir_len] = '/';
+    }
+    memcpy(path + dir_len + sep, name, name_len + 1);
+
+    int type = get_entry_type(path, d_type);
+    if (type == DT_REG && match_extension(name, walk->extensions)) {
+        walk->count++;
+        if (walk->callback(path, walk->user_data) != 0) {
+            walk->stop = 1;
         }
+    } else if (type == DT_DIR && is_dir_candidate) {
+        walk_directory(walk, path);
     }
+    path[dir_len] = '\0';
+}
 
+int walk_image_files(const char* directory_path, const char* extensions, int flags,
+                     file_walk_callback callback, void* user_data)
+{
+    if (directory_path == NULL || callback == NULL) {
+        return -1;
+    }
+    char path[PATH_MAX];
+    if (strlen(directory_path) >= sizeof(path)) {
+        printf("路径过长: %s\n", directory_path);
+        return -1;
+    }
+    strcpy(path, directory_path);
+
+    DIR* dir = opendir(path);
+    if (dir == NULL) {
+        printf("无法打开目录: %s\n", directory_path);
+        return -1;
+    }
     closedir(dir);
 
-    *file_count = count;
-    return image_files;
+    file_walk_t walk;
+    memset(&walk, 0, sizeof(file_walk_t));
+    walk.extensions = extensions;
+    walk.flags = flags;
+    walk.callback = callback;
+    walk.user_data = user_data;
+    walk_directory(&walk, path);
+    return walk.count;
+}
+
+typedef struct {
+    char** files;
+    int count;
+    int capacity;
+} file_list_t;
+
+static int append_file(const char* path, void* user_data)
+{
+    file_list_t* list = (file_list_t*)user_data;
+    if (list->count >= list->capacity) {
+        int capacity = list->capacity > 0 ? list->capacity * 2 : 16;
+        char** temp = (char**)realloc(list->files, capacity * sizeof(char*));
+        if (temp == NULL) {
+            printf("内存重新分配失败\n");
+            return -1;
+        }
+        list->files = temp;
+        list->capacity = capacity;
+    }
+    list->files[list->count] = strdup(path);
+    if (list->files[list->count] == NULL) {
+        printf("内存分配失败\n");
+        return -1;
+    }
+    list->count++;
+    return 0;
+}
+
+char** get_image_files_from_directory(const char* directory_path, int* file_count)
+{
+    file_list_t list;
+    memset(&list, 0, sizeof(file_list_t));
+    *file_count = 0;
+
+    if (walk_image_files(directory_path, NULL, 0, append_file, &list) < 0) {
+        return NULL;
+    }
+    if (list.files == NULL) {
+        // 保持原来的约定: 目录可以打开时返回非 NULL
+        list.files = (char**)malloc(sizeof(char*));
+    }
+    *file_count = list.count;
+    return list.files;
 }
 
 void free_file_list(char** file_list, int file_count)
@@ -49,6 +49,42 @@ void free_lines(char** lines, int line_count);
  */
 int is_image_file(const char* filename);
 
+/**
+ * @brief Create a directory and its missing parents (mkdir -p)
+ *
+ * @param path [in] Directory path
+ * @return int 0: success or already exists; -1: error
+ */
+int make_directories(const char* path);
+
+#define FILE_WALK_RECURSIVE 0x1     // 递归进入子目录（跳过以 . 开头的目录）
+#define FILE_WALK_SORTED    0x2     // 每层目录按名字排序，遍历顺序固定
+
+/**
+ * @brief Called for each file found by walk_image_files()
+ *
+ * @param path [in] File path, only valid during the call
+ * @param user_data [in] User data passed to walk_image_files()
+ * @return int 0: continue; non-zero: stop walking
+ */
+typedef int (*file_walk_callback)(const char* path, void* user_data);
+
+/**
+ * @brief Walk a directory and call callback for each matching file while scanning
+ *
+ * Entry types come from readdir d_type, stat is only used for symlinks and file systems
+ * that report DT_UNKNOWN. Symlinks to files are followed, symlinks to directories are not.
+ *
+ * @param directory_path [in] Directory path
+ * @param extensions [in] Comma separated extensions, e.g. ".jpg,.png" (case insensitive); NULL: is_image_file()
+ * @param flags [in] FILE_WALK_* flags
+ * @param callback [in] Called for each matching file
+ * @param user_data [in] Passed to callback
+ * @return int -1: error; >= 0: number of files passed to callback
+ */
+int walk_image_files(const char* directory_path, const char* extensions, int flags,
+                     file_walk_callback callback, void* user_data);
+
 /**
  * @brief Get all image files from directory
  *
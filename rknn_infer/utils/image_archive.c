@@ -0,0 +1,399 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <endian.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "image_archive.h"
+#include "image_utils.h"
+#include "image_buffer_pool.h"
+#include "file_utils.h"
+
+int is_image_archive(const char* path)
+{
+    char magic[8];
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return 0;
+    }
+    int ok = fread(magic, sizeof(magic), 1, fp) == 1 && memcmp(magic, IMAGE_ARCHIVE_MAGIC, sizeof(magic)) == 0;
+    fclose(fp);
+    return ok;
+}
+
+static void decode_header(const image_archive_header_t* src, image_archive_header_t* header)
+{
+    memcpy(header->magic, src->magic, sizeof(header->magic));
+    header->version = le32toh(src->version);
+    header->count = le32toh(src->count);
+    header->index_offset = le64toh(src->index_offset);
+    header->names_offset = le64toh(src->names_offset);
+    header->names_size = le64toh(src->names_size);
+}
+
+static void encode_header(const image_archive_header_t* src, image_archive_header_t* header)
+{
+    memcpy(header->magic, src->magic, sizeof(header->magic));
+    header->version = htole32(src->version);
+    header->count = htole32(src->count);
+    header->index_offset = htole64(src->index_offset);
+    header->names_offset = htole64(src->names_offset);
+    header->names_size = htole64(src->names_size);
+}
+
+// 编码和解码都是逐字段交换字节序，同一个函数两用
+static void swap_entry(const image_archive_entry_t* src, image_archive_entry_t* entry)
+{
+    entry->offset = htole64(src->offset);
+    entry->size = htole64(src->size);
+    entry->name_offset = htole32(src->name_offset);
+    entry->type = htole32(src->type);
+    entry->width = (int32_t)htole32((uint32_t)src->width);
+    entry->height = (int32_t)htole32((uint32_t)src->height);
+    entry->format = (int32_t)htole32((uint32_t)src->format);
+    entry->channel = (int32_t)htole32((uint32_t)src->channel);
+}
+
+static int check_header(const image_archive_t* archive, const image_archive_header_t* header)
+{
+    if (memcmp(header->magic, IMAGE_ARCHIVE_MAGIC, sizeof(header->magic)) != 0) {
+        printf("not an image archive\n");
+        return -1;
+    }
+    if (header->version != IMAGE_ARCHIVE_VERSION) {
+        printf("unsupported image archive version %u\n", header->version);
+        return -1;
+    }
+    uint64_t index_size = (uint64_t)header->count * sizeof(image_archive_entry_t);
+    if (header->index_offset > archive->size || index_size > archive->size - header->index_offset ||
+        header->index_offset % sizeof(uint64_t) != 0 ||
+        header->names_offset > archive->size || header->names_size > archive->size - header->names_offset ||
+        (header->names_size > 0 && archive->base[header->names_offset + header->names_size - 1] != '\0')) {
+        printf("image archive index out of range\n");
+        return -1;
+    }
+    return 0;
+}
+
+static int check_entries(const image_archive_t* archive, const image_archive_header_t* header)
+{
+    for (uint32_t i = 0; i < header->count; i++) {
+        const image_archive_entry_t* entry = &archive->entries[i];
+        if (entry->offset > archive->size || entry->size > archive->size - entry->offset ||
+            entry->name_offset >= header->names_size) {
+            printf("image archive entry %u out of range\n", i);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int open_image_archive(const char* path, image_archive_t* archive)
+{
+    struct stat st;
+    memset(archive, 0, sizeof(image_archive_t));
+    archive->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (archive->fd < 0) {
+        printf("open %s fail\n", path);
+        return -1;
+    }
+    if (fstat(archive->fd, &st) != 0 || st.st_size <= 0) {
+        printf("stat %s fail\n", path);
+        close_image_archive(archive);
+        return -1;
+    }
+    archive->size = st.st_size;
+    void* base = mmap(NULL, archive->size, PROT_READ, MAP_SHARED, archive->fd, 0);
+    if (base == MAP_FAILED) {
+        printf("mmap %s fail\n", path);
+        archive->size = 0;
+        close_image_archive(archive);
+        return -1;
+    }
+    archive->base = (unsigned char*)base;
+    // 按打包顺序读取，让内核提前预读、读过的页尽早回收
+    madvise(archive->base, archive->size, MADV_SEQUENTIAL);
+
+    image_archive_header_t header;
+    if (archive->size < sizeof(image_archive_header_t)) {
+        printf("not an image archive\n");
+        close_image_archive(archive);
+        return -1;
+    }
+    decode_header((const image_archive_header_t*)archive->base, &header);
+    if (check_header(archive, &header) != 0) {
+        close_image_archive(archive);
+        return -1;
+    }
+    const image_archive_entry_t* entries = (const image_archive_entry_t*)(archive->base + header.index_offset);
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+    // 小端主机上索引直接用映射，不复制
+    archive->entries = entries;
+#else
+    if (header.count > 0) {
+        archive->decoded_entries = (image_archive_entry_t*)malloc(header.count * sizeof(image_archive_entry_t));
+        if (archive->decoded_entries == NULL) {
+            close_image_archive(archive);
+            return -1;
+        }
+        for (uint32_t i = 0; i < header.count; i++) {
+            swap_entry(&entries[i], &archive->decoded_entries[i]);
+        }
+    }
+    archive->entries = archive->decoded_entries;
+#endif
+    if (check_entries(archive, &header) != 0) {
+        close_image_archive(archive);
+        return -1;
+    }
+    archive->count = header.count;
+    archive->names = (const char*)(archive->base + header.names_offset);
+    return 0;
+}
+
+void close_image_archive(image_archive_t* archive)
+{
+    if (archive->base != NULL) {
+        munmap(archive->base, archive->size);
+    }
+    if (archive->fd >= 0) {
+        close(archive->fd);
+    }
+    free(archive->decoded_entries);
+    memset(archive, 0, sizeof(image_archive_t));
+    archive->fd = -1;
+}
+
+const char* get_image_archive_name(const image_archive_t* archive, int index)
+{
+    if (index < 0 || index >= archive->count) {
+        return NULL;
+    }
+    return archive->names + archive->entries[index].name_offset;
+}
+
+const unsigned char* get_image_archive_data(const image_archive_t* archive, int index, size_t* size)
+{
+    if (index < 0 || index >= archive->count) {
+        return NULL;
+    }
+    const image_archive_entry_t* entry = &archive->entries[index];
+    *size = entry->size;
+    return archive->base + entry->offset;
+}
+
+static int read_raw_entry(const image_archive_entry_t* entry, const unsigned char* data, image_buffer_t* image)
+{
+    image_buffer_t raw;
+    if (entry->width <= 0 || entry->height <= 0 || entry->width > 65535 || entry->height > 65535) {
+        printf("raw entry size %dx%d invalid\n", entry->width, entry->height);
+        return -1;
+    }
+    memset(&raw, 0, sizeof(image_buffer_t));
+    raw.width = entry->width;
+    raw.height = entry->height;
+    raw.format = (image_format_t)entry->format;
+    int size = get_image_size(&raw);
+    if (size <= 0 || (uint64_t)size > entry->size) {
+        printf("raw entry size %llu too small, need %d\n", (unsigned long long)entry->size, size);
+        return -1;
+    }
+    if (image->virt_addr != NULL) {
+        if (image->size > 0 && image->size < size) {
+            printf("image buffer too small: %d < %d\n", image->size, size);
+            return -1;
+        }
+        raw.virt_addr = image->virt_addr;
+        raw.fd = image->fd;
+    } else if (alloc_image_buffer(&raw) != 0) {
+        return -1;
+    }
+    sync_image_for_cpu(&raw);
+    memcpy(raw.virt_addr, data, size);
+    sync_image_for_device(&raw);
+
+    image->width = raw.width;
+    image->height = raw.height;
+    image->width_stride = raw.width;
+    image->height_stride = raw.height;
+    image->orig_width = raw.width;
+    image->orig_height = raw.height;
+    image->format = raw.format;
+    image->virt_addr = raw.virt_addr;
+    image->fd = raw.fd;
+    image->size = size;
+    return 0;
+}
+
+int read_image_from_archive(const image_archive_t* archive, int index, image_buffer_t* image, int min_width,
+                            int min_height, int flags)
+{
+    size_t size = 0;
+    const unsigned char* data = get_image_archive_data(archive, index, &size);
+    if (data == NULL) {
+        printf("archive entry %d out of range\n", index);
+        return -1;
+    }
+    const image_archive_entry_t* entry = &archive->entries[index];
+    if (entry->type == IMAGE_ARCHIVE_RAW) {
+        return read_raw_entry(entry, data, image);
+    }
+    return read_image_from_memory(data, (int)size, image, min_width, min_height, flags);
+}
+
+int create_image_archive(const char* path, image_archive_writer_t* writer)
+{
+    memset(writer, 0, sizeof(image_archive_writer_t));
+    writer->fp = fopen(path, "wb");
+    if (writer->fp == NULL) {
+        printf("create %s fail\n", path);
+        return -1;
+    }
+    // 先占位，finish 时回写
+    image_archive_header_t header;
+    memset(&header, 0, sizeof(header));
+    if (fwrite(&header, sizeof(header), 1, writer->fp) != 1) {
+        fclose(writer->fp);
+        writer->fp = NULL;
+        return -1;
+    }
+    writer->offset = sizeof(header);
+    return 0;
+}
+
+static int write_padding(image_archive_writer_t* writer, uint64_t align)
+{
+    static const unsigned char zeros[IMAGE_ARCHIVE_ALIGN];
+    uint64_t pad = (align - writer->offset % align) % align;
+    if (pad > 0 && fwrite(zeros, 1, pad, writer->fp) != pad) {
+        return -1;
+    }
+    writer->offset += pad;
+    return 0;
+}
+
+int image_archive_add(image_archive_writer_t* writer, const char* name, const unsigned char* data, size_t size,
+                      int type, int width, int height, int format, int channel)
+{
+    if (writer->fp == NULL) {
+        return -1;
+    }
+    if (writer->count >= writer->capacity) {
+        int capacity = writer->capacity > 0 ? writer->capacity * 2 : 256;
+        image_archive_entry_t* entries =
+            (image_archive_entry_t*)realloc(writer->entries, capacity * sizeof(image_archive_entry_t));
+        if (entries == NULL) {
+            return -1;
+        }
+        writer->entries = entries;
+        writer->capacity = capacity;
+    }
+    size_t name_len = strlen(name) + 1;
+    if (writer->names_size + name_len > writer->names_capacity) {
+        size_t capacity = writer->names_capacity > 0 ? writer->names_capacity * 2 : 16384;
+        while (capacity < writer->names_size + name_len) {
+            capacity *= 2;
+        }
+        char* names = (char*)realloc(writer->names, capacity);
+        if (names == NULL) {
+            return -1;
+        }
+        writer->names = names;
+        writer->names_capacity = capacity;
+    }
+
+    if (write_padding(writer, IMAGE_ARCHIVE_ALIGN) != 0 || fwrite(data, 1, size, writer->fp) != size) {
+        printf("write archive entry %s fail\n", name);
+        return -1;
+    }
+
+    image_archive_entry_t* entry = &writer->entries[writer->count++];
+    memset(entry, 0, sizeof(image_archive_entry_t));
+    entry->offset = writer->offset;
+    entry->size = size;
+    entry->name_offset = (uint32_t)writer->names_size;
+    entry->type = type;
+    entry->width = width;
+    entry->height = height;
+    entry->format = format;
+    entry->channel = channel;
+    memcpy(writer->names + writer->names_size, name, name_len);
+    writer->names_size += name_len;
+    writer->offset += size;
+    return 0;
+}
+
+int image_archive_add_file(image_archive_writer_t* writer, const char* path, const char* name)
+{
+    char* data = NULL;
+    int size = read_data_from_file(path, &data);
+    if (size <= 0) {
+        printf("read %s fail\n", path);
+        free(data);
+        return -1;
+    }
+    int width, height, channel;
+    if (get_image_info_from_memory((const unsigned char*)data, size, &width, &height, &channel) != 0) {
+        printf("unsupported image: %s\n", path);
+        free(data);
+        return -1;
+    }
+    int ret = image_archive_add(writer, name, (const unsigned char*)data, size, IMAGE_ARCHIVE_ENCODED, width, height,
+                                -1, channel);
+    free(data);
+    return ret;
+}
+
+int finish_image_archive(image_archive_writer_t* writer)
+{
+    int ret = -1;
+    image_archive_header_t header;
+    image_archive_header_t le_header;
+    if (writer->fp == NULL) {
+        return -1;
+    }
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, IMAGE_ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = IMAGE_ARCHIVE_VERSION;
+    header.count = writer->count;
+
+    if (write_padding(writer, sizeof(uint64_t)) != 0) {
+        goto out;
+    }
+    header.index_offset = writer->offset;
+    // 索引写出后不再使用，原地转换为小端
+    for (int i = 0; i < writer->count; i++) {
+        image_archive_entry_t entry = writer->entries[i];
+        swap_entry(&entry, &writer->entries[i]);
+    }
+    if (writer->count > 0 &&
+        fwrite(writer->entries, sizeof(image_archive_entry_t), writer->count, writer->fp) != (size_t)writer->count) {
+        goto out;
+    }
+    writer->offset += (uint64_t)writer->count * sizeof(image_archive_entry_t);
+    header.names_offset = writer->offset;
+    header.names_size = writer->names_size;
+    if (writer->names_size > 0 && fwrite(writer->names, 1, writer->names_size, writer->fp) != writer->names_size) {
+        goto out;
+    }
+    // 头部最后写，中途失败的文件不会被识别为有效的包
+    encode_header(&header, &le_header);
+    if (fseek(writer->fp, 0, SEEK_SET) != 0 || fwrite(&le_header, sizeof(le_header), 1, writer->fp) != 1) {
+        goto out;
+    }
+    ret = 0;
+out:
+    if (fclose(writer->fp) != 0) {
+        ret = -1;
+    }
+    if (ret != 0) {
+        printf("write image archive fail\n");
+    }
+    free(writer->entries);
+    free(writer->names);
+    memset(writer, 0, sizeof(image_archive_writer_t));
+    return ret;
+}
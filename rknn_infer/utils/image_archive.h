@@ -0,0 +1,173 @@
+#ifndef _RKNN_MODEL_ZOO_IMAGE_ARCHIVE_H_
+#define _RKNN_MODEL_ZOO_IMAGE_ARCHIVE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Packed image archive (.rkpack), all integer fields little endian (converted on write and read,
+ * so archives packed on the PC open on the board and vice versa):
+ *
+ *   image_archive_header_t
+ *   payloads            JPEG/PNG files or raw pixels, each aligned to IMAGE_ARCHIVE_ALIGN
+ *   index               image_archive_entry_t[count]
+ *   name table          NUL terminated names, referenced by entry name_offset
+ *
+ * The index is written last, so an archive is packed in one streaming pass.
+ */
+#define IMAGE_ARCHIVE_MAGIC   "RKIMGPAK"
+#define IMAGE_ARCHIVE_VERSION 1
+#define IMAGE_ARCHIVE_ALIGN   64
+
+#define IMAGE_ARCHIVE_ENCODED 0     // JPEG/PNG file content
+#define IMAGE_ARCHIVE_RAW     1     // tightly packed pixels in entry format
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint64_t index_offset;
+    uint64_t names_offset;
+    uint64_t names_size;
+} image_archive_header_t;
+
+typedef struct {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t name_offset;
+    uint32_t type;          // IMAGE_ARCHIVE_ENCODED / IMAGE_ARCHIVE_RAW
+    int32_t width;
+    int32_t height;
+    int32_t format;         // image_format_t of raw payloads, -1 for encoded
+    int32_t channel;
+} image_archive_entry_t;
+
+typedef struct {
+    int fd;
+    unsigned char* base;
+    size_t size;
+    int count;
+    const image_archive_entry_t* entries;   // Host byte order
+    const char* names;
+    image_archive_entry_t* decoded_entries; // Big endian hosts: decoded copy of the index; little endian: NULL, entries points into the mapping
+} image_archive_t;
+
+typedef struct {
+    FILE* fp;
+    uint64_t offset;
+    image_archive_entry_t* entries;
+    int count;
+    int capacity;
+    char* names;
+    size_t names_size;
+    size_t names_capacity;
+} image_archive_writer_t;
+
+/**
+ * @brief Check the archive magic of a file
+ *
+ * @param path [in] File path
+ * @return int 1: is an image archive; 0: not
+ */
+int is_image_archive(const char* path);
+
+/**
+ * @brief Open an archive, it is mmap'ed read-only and the index is validated
+ *
+ * @param path [in] Archive path
+ * @param archive [out] Archive, release with close_image_archive()
+ * @return int 0: success; -1: error
+ */
+int open_image_archive(const char* path, image_archive_t* archive);
+
+void close_image_archive(image_archive_t* archive);
+
+/**
+ * @brief Get the name of an archive entry
+ *
+ * @return const char* Name, valid until the archive is closed
+ */
+const char* get_image_archive_name(const image_archive_t* archive, int index);
+
+/**
+ * @brief Get the payload of an archive entry, a pointer into the mapping (no copy)
+ *
+ * @param archive [in] Archive
+ * @param index [in] Entry index
+ * @param size [out] Payload size
+ * @return const unsigned char* Payload, valid until the archive is closed
+ */
+const unsigned char* get_image_archive_data(const image_archive_t* archive, int index, size_t* size);
+
+/**
+ * @brief Decode an archive entry, same as read_image_scaled
+ *
+ * Encoded payloads are decoded straight from the mapping; raw payloads are copied into the image buffer.
+ *
+ * @param archive [in] Archive
+ * @param index [in] Entry index
+ * @param image [out] Decoded image, release with free_image_buffer
+ * @param min_width [in] Model input width, 0: full size
+ * @param min_height [in] Model input height, 0: full size
+ * @param flags [in] IMAGE_DECODE_*
+ * @return int 0: success; -1: error
+ */
+int read_image_from_archive(const image_archive_t* archive, int index, image_buffer_t* image, int min_width,
+                            int min_height, int flags);
+
+/**
+ * @brief Create an archive for writing
+ *
+ * @param path [in] Archive path
+ * @param writer [out] Writer
+ * @return int 0: success; -1: error
+ */
+int create_image_archive(const char* path, image_archive_writer_t* writer);
+
+/**
+ * @brief Append one payload
+ *
+ * @param writer [in] Writer
+ * @param name [in] Entry name
+ * @param data [in] Payload
+ * @param size [in] Payload size
+ * @param type [in] IMAGE_ARCHIVE_ENCODED / IMAGE_ARCHIVE_RAW
+ * @param width [in] Image width
+ * @param height [in] Image height
+ * @param format [in] image_format_t for raw payloads, -1 for encoded
+ * @param channel [in] Channels
+ * @return int 0: success; -1: error
+ */
+int image_archive_add(image_archive_writer_t* writer, const char* name, const unsigned char* data, size_t size,
+                      int type, int width, int height, int format, int channel);
+
+/**
+ * @brief Append a JPEG/PNG file, the size is read from its header
+ *
+ * @param writer [in] Writer
+ * @param path [in] Image file
+ * @param name [in] Entry name
+ * @return int 0: success; -1: error
+ */
+int image_archive_add_file(image_archive_writer_t* writer, const char* path, const char* name);
+
+/**
+ * @brief Write the index and header and close the archive
+ *
+ * @param writer [in] Writer
+ * @return int 0: success; -1: error
+ */
+int finish_image_archive(image_archive_writer_t* writer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif // _RKNN_MODEL_ZOO_IMAGE_ARCHIVE_H_
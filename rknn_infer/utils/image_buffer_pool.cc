@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "dma_alloc.h"
+
+#include "image_buffer_pool.h"
+#include "image_utils.h"
+
+// 空闲块最多保留的数量，超出时直接归还系统
+#define IMAGE_POOL_MAX_IDLE 16
+#define IMAGE_POOL_MIN_CLASS (64 * 1024)
+
+typedef struct _pool_block_t {
+    unsigned char* va;
+    int fd;             // -1: 普通内存
+    size_t size;        // 所属尺寸档位
+    int in_use;
+    struct _pool_block_t* next;
+} pool_block_t;
+
+static pool_block_t* pool_blocks;
+static int pool_idle_count;
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char* dma_heap_path;
+static pthread_once_t dma_heap_once = PTHREAD_ONCE_INIT;
+
+// dma32 优先: RGA2 只能访问 4G 以下的物理地址
+static void probe_dma_heap()
+{
+    const char* env = getenv("IMAGE_DMA_HEAP");
+    if (env != NULL) {
+        dma_heap_path = (env[0] != '\0' && access(env, R_OK | W_OK) == 0) ? env : NULL;
+    } else if (access(DMA_HEAP_DMA32_PATCH, R_OK | W_OK) == 0) {
+        dma_heap_path = DMA_HEAP_DMA32_PATCH;
+    } else if (access(DMA_HEAP_PATH, R_OK | W_OK) == 0) {
+        dma_heap_path = DMA_HEAP_PATH;
+    }
+    if (dma_heap_path != NULL) {
+        printf("image buffer pool: %s\n", dma_heap_path);
+    } else {
+        printf("image buffer pool: no dma heap, use system memory\n");
+    }
+}
+
+// 尺寸档位: 每个 2 的幂区间再分 4 档，浪费不超过 25%，相近分辨率的帧能复用同一块
+static size_t get_size_class(size_t size)
+{
+    if (size <= IMAGE_POOL_MIN_CLASS) {
+        return IMAGE_POOL_MIN_CLASS;
+    }
+    size_t p = IMAGE_POOL_MIN_CLASS;
+    while (p * 2 <= size) {
+        p *= 2;
+    }
+    size_t step = p / 4;
+    return (size + step - 1) / step * step;
+}
+
+static pool_block_t* create_block(size_t size)
+{
+    pool_block_t* block = (pool_block_t*)malloc(sizeof(pool_block_t));
+    if (block == NULL) {
+        return NULL;
+    }
+    memset(block, 0, sizeof(pool_block_t));
+    block->fd = -1;
+    block->size = size;
+
+    pthread_once(&dma_heap_once, probe_dma_heap);
+    if (dma_heap_path != NULL) {
+        void* va = NULL;
+        if (dma_buf_alloc(dma_heap_path, size, &block->fd, &va) == 0) {
+            block->va = (unsigned char*)va;
+            return block;
+        }
+        printf("dma_buf_alloc size %zu fail, use system memory\n", size);
+        block->fd = -1;
+    }
+    block->va = (unsigned char*)malloc(size);
+    if (block->va == NULL) {
+        printf("malloc size %zu fail\n", size);
+        free(block);
+        return NULL;
+    }
+    return block;
+}
+
+static void destroy_block(pool_block_t* block)
+{
+    if (block->fd >= 0) {
+        // fd 关闭后编号会被复用，先丢掉 RGA 缓存的导入句柄
+        image_buffer_t image;
+        memset(&image, 0, sizeof(image_buffer_t));
+        image.fd = block->fd;
+        invalidate_image_handle(&image);
+        dma_buf_free(block->size, &block->fd, block->va);
+    } else {
+        free(block->va);
+    }
+    free(block);
+}
+
+int alloc_image_buffer(image_buffer_t* image)
+{
+    if (image == NULL) {
+        return -1;
+    }
+    int size = get_image_size(image);
+    if (image->size > size) {
+        size = image->size;
+    }
+    if (size <= 0) {
+        printf("alloc_image_buffer: invalid size %d\n", size);
+        return -1;
+    }
+    size_t class_size = get_size_class(size);
+
+    pool_block_t* block = NULL;
+    pthread_mutex_lock(&pool_lock);
+    for (pool_block_t* b = pool_blocks; b != NULL; b = b->next) {
+        if (!b->in_use && b->size == class_size) {
+            block = b;
+            block->in_use = 1;
+            pool_idle_count--;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    if (block == NULL) {
+        block = create_block(class_size);
+        if (block == NULL) {
+            return -1;
+        }
+        block->in_use = 1;
+        pthread_mutex_lock(&pool_lock);
+        block->next = pool_blocks;
+        pool_blocks = block;
+        pthread_mutex_unlock(&pool_lock);
+    }
+
+    image->virt_addr = block->va;
+    image->fd = block->fd >= 0 ? block->fd : 0;
+    image->size = size;
+    return 0;
+}
+
+void free_image_buffer(image_buffer_t* image)
+{
+    if (image == NULL || image->virt_addr == NULL) {
+        return;
+    }
+    pool_block_t* block = NULL;
+    pool_block_t* drop = NULL;
+    pthread_mutex_lock(&pool_lock);
+    for (pool_block_t** pb = &pool_blocks; *pb != NULL; pb = &(*pb)->next) {
+        if ((*pb)->va == image->virt_addr) {
+            block = *pb;
+            if (pool_idle_count >= IMAGE_POOL_MAX_IDLE) {
+                *pb = block->next;
+                drop = block;
+            } else {
+                block->in_use = 0;
+                pool_idle_count++;
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    if (block == NULL) {
+        // 不是池分配的内存
+        free(image->virt_addr);
+    } else if (drop != NULL) {
+        destroy_block(drop);
+    }
+    image->virt_addr = NULL;
+    image->fd = 0;
+}
+
+int sync_image_for_cpu(image_buffer_t* image)
+{
+    if (image == NULL || image->fd <= 0) {
+        return 0;
+    }
+    return dma_sync_device_to_cpu(image->fd) < 0 ? -1 : 0;
+}
+
+int sync_image_for_device(image_buffer_t* image)
+{
+    if (image == NULL || image->fd <= 0) {
+        return 0;
+    }
+    return dma_sync_cpu_to_device(image->fd) < 0 ? -1 : 0;
+}
+
+void release_image_buffer_pool()
+{
+    pool_block_t* idle = NULL;
+    pthread_mutex_lock(&pool_lock);
+    pool_block_t** pb = &pool_blocks;
+    while (*pb != NULL) {
+        pool_block_t* block = *pb;
+        if (!block->in_use) {
+            *pb = block->next;
+            block->next = idle;
+            idle = block;
+        } else {
+            pb = &block->next;
+        }
+    }
+    pool_idle_count = 0;
+    pthread_mutex_unlock(&pool_lock);
+
+    while (idle != NULL) {
+        pool_block_t* next = idle->next;
+        destroy_block(idle);
+        idle = next;
+    }
+}
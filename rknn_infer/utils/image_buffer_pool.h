@@ -0,0 +1,57 @@
+#ifndef _RKNN_MODEL_ZOO_IMAGE_BUFFER_POOL_H_
+#define _RKNN_MODEL_ZOO_IMAGE_BUFFER_POOL_H_
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Allocate image memory from the DMA-heap backed buffer pool
+ *
+ * Size is get_image_size(image) (or image->size if larger), rounded up to a size class.
+ * Buffers come from /dev/dma_heap (system-dma32, then system; IMAGE_DMA_HEAP overrides the path)
+ * and image->fd is set, so RGA and the NPU use them without copies. Without a DMA heap the
+ * pool hands out ordinary memory and image->fd stays 0.
+ *
+ * @param image [in/out] width/height/width_stride/height_stride/format set; virt_addr, fd and size are filled
+ * @return int 0: success; -1: error
+ */
+int alloc_image_buffer(image_buffer_t* image);
+
+/**
+ * @brief Return image memory to the pool
+ *
+ * Memory that was not allocated by the pool (malloc'ed) is passed to free().
+ *
+ * @param image [in/out] virt_addr and fd are cleared
+ */
+void free_image_buffer(image_buffer_t* image);
+
+/**
+ * @brief Begin CPU access to an fd-backed image (invalidate cache), no-op without fd
+ *
+ * @param image [in] Image
+ * @return int 0: success; -1: error
+ */
+int sync_image_for_cpu(image_buffer_t* image);
+
+/**
+ * @brief End CPU access to an fd-backed image (flush cache) before RGA/NPU use it, no-op without fd
+ *
+ * @param image [in] Image
+ * @return int 0: success; -1: error
+ */
+int sync_image_for_device(image_buffer_t* image);
+
+/**
+ * @brief Release the idle buffers kept by the pool
+ */
+void release_image_buffer_pool();
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif // _RKNN_MODEL_ZOO_IMAGE_BUFFER_POOL_H_
@@ -1476,8 +1476,8 @@ void draw_rectangle(image_buffer_t* image, int rx, int ry, int rw, int rh, unsig
 {
     image_format_t format = image->format;
     unsigned char* pixels = image->virt_addr;
-    int w = image->width;
-    int h = image->height;
+    int w = image->width_stride > 0 ? image->width_stride : image->width;
+    int h = image->height_stride > 0 ? image->height_stride : image->height;
 
     unsigned int draw_color = convert_color(color, format);
     // printf("draw_color=%x\n", draw_color);
@@ -1507,8 +1507,8 @@ void draw_line(image_buffer_t* image, int x0, int y0, int x1, int y1, unsigned i
 {
     image_format_t format = image->format;
     unsigned char* pixels = image->virt_addr;
-    int w = image->width;
-    int h = image->height;
+    int w = image->width_stride > 0 ? image->width_stride : image->width;
+    int h = image->height_stride > 0 ? image->height_stride : image->height;
 
     unsigned draw_color = convert_color(color, format);
 
@@ -1566,8 +1566,8 @@ void draw_text(image_buffer_t* image, const char* text, int x, int y, unsigned i
 {
     image_format_t format = image->format;
     unsigned char* pixels = image->virt_addr;
-    int w = image->width;
-    int h = image->height;
+    int w = image->width_stride > 0 ? image->width_stride : image->width;
+    int h = image->height_stride > 0 ? image->height_stride : image->height;
     unsigned int draw_color = convert_color(color, format);
 
     switch (format)
@@ -1593,8 +1593,8 @@ void draw_circle(image_buffer_t* image, int cx, int cy, int radius, unsigned int
 {
     image_format_t format = image->format;
     unsigned char* pixels = image->virt_addr;
-    int w = image->width;
-    int h = image->height;
+    int w = image->width_stride > 0 ? image->width_stride : image->width;
+    int h = image->height_stride > 0 ? image->height_stride : image->height;
     unsigned draw_color = convert_color(color, format);
 
     switch (format)
@@ -1619,8 +1619,8 @@ void draw_image(image_buffer_t* image, unsigned char* draw_img, int x, int y, in
 {
     image_format_t format = image->format;
     unsigned char* pixels = image->virt_addr;
-    int w = image->width;
-    int h = image->height;
+    int w = image->width_stride > 0 ? image->width_stride : image->width;
+    int h = image->height_stride > 0 ? image->height_stride : image->height;
 
     switch (format)
     {
@@ -0,0 +1,841 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "image_resize.h"
+
+// 系数定点位数: 权重和为 1 << RESIZE_COEF_BITS
+#define RESIZE_COEF_BITS 11
+#define RESIZE_COEF_SCALE (1 << RESIZE_COEF_BITS)
+// 水平结果右移 RESIZE_ROW_SHIFT 位存为 int16 (Q7)，垂直结果再整体右移
+#define RESIZE_ROW_SHIFT 4
+#define RESIZE_OUT_SHIFT (RESIZE_COEF_BITS * 2 - RESIZE_ROW_SHIFT)
+
+#define RESIZE_PLAN_CACHE_SIZE 4
+
+#define RESIZE_MAX_THREADS 8
+#define RESIZE_MIN_BAND_ROWS 16    // 每个分块至少的输出行数，太小时线程同步开销占主导
+
+/*
+ * 源像素布局: 每个源像素 step 字节，输出第 c 个通道取像素内偏移 ofs[c] 的字节。
+ * 紧密排列的 n 通道图像是 {n, {0, 1, .., n-1}}，YUYV 的亮度是 {2, {0}}。
+ */
+typedef struct {
+    int step;
+    int ofs[4];
+} pixel_layout_t;
+
+/*
+ * 缩放计划: 与源/目标尺寸相关的系数表，同一尺寸的帧复用
+ * 水平方向按输出元素 (像素 * 通道) 展开，所以 1/3/4 通道走同一个内核
+ */
+typedef struct {
+    int channel;
+    pixel_layout_t layout;
+    int src_width;
+    int src_height;
+    int crop_x;
+    int crop_y;
+    int crop_width;
+    int crop_height;
+    int dst_width;
+    int dst_height;
+    unsigned int last_used;
+
+    int* xofs;          // 每个输出元素的两个源字节偏移，两两一组
+    int16_t* xalpha;    // 对应权重，两两一组 (w0, w1)
+    int* yofs;          // 每个输出行的两个源行号
+    int16_t* yalpha;
+    int16_t* rows[2];   // 水平缩放后的两行
+    int row_y[2];       // rows 对应的源行号，-1 表示无效
+    unsigned char* out_row;     // 输出需要扩展通道时的单通道结果行
+} resize_plan_t;
+
+typedef struct {
+    resize_plan_t* plans[RESIZE_PLAN_CACHE_SIZE];
+    unsigned int tick;
+} resize_plan_cache_t;
+
+static pthread_key_t plan_cache_key;
+static pthread_once_t plan_cache_once = PTHREAD_ONCE_INIT;
+
+static void free_plan(resize_plan_t* plan)
+{
+    if (plan == NULL) {
+        return;
+    }
+    free(plan->xofs);
+    free(plan->xalpha);
+    free(plan->yofs);
+    free(plan->yalpha);
+    free(plan->rows[0]);
+    free(plan->rows[1]);
+    free(plan->out_row);
+    free(plan);
+}
+
+static void free_plan_cache(void* data)
+{
+    resize_plan_cache_t* cache = (resize_plan_cache_t*)data;
+    for (int i = 0; i < RESIZE_PLAN_CACHE_SIZE; i++) {
+        free_plan(cache->plans[i]);
+    }
+    free(cache);
+}
+
+static void create_plan_cache_key()
+{
+    pthread_key_create(&plan_cache_key, free_plan_cache);
+}
+
+// 与浮点参考实现相同的取样: 左/上对齐，最右/最下一个像素与内侧相邻像素插值
+static void compute_axis(int dst_len, int crop_pos, int crop_len, int src_len, int* ofs, int16_t* alpha)
+{
+    float ratio = (float)crop_len / (float)dst_len;
+    for (int d = 0; d < dst_len; d++) {
+        float fpos = d * ratio;
+        int s = (int)fpos + crop_pos;
+        float diff = fpos - (s - crop_pos);
+        int s1 = (s == src_len - 1) ? s - 1 : s + 1;
+        if (s1 < 0) {
+            s1 = 0;
+        }
+        int a = (int)(diff * RESIZE_COEF_SCALE + 0.5f);
+        a = a < 0 ? 0 : (a > RESIZE_COEF_SCALE ? RESIZE_COEF_SCALE : a);
+        ofs[d * 2] = s;
+        ofs[d * 2 + 1] = s1;
+        alpha[d * 2] = (int16_t)(RESIZE_COEF_SCALE - a);
+        alpha[d * 2 + 1] = (int16_t)a;
+    }
+}
+
+static resize_plan_t* create_plan(int channel, const pixel_layout_t* layout, int src_width, int src_height,
+                                  int crop_x, int crop_y, int crop_width, int crop_height,
+                                  int dst_width, int dst_height)
+{
+    resize_plan_t* plan = (resize_plan_t*)calloc(1, sizeof(resize_plan_t));
+    if (plan == NULL) {
+        return NULL;
+    }
+    int n = dst_width * channel;
+    plan->channel = channel;
+    plan->layout = *layout;
+    plan->src_width = src_width;
+    plan->src_height = src_height;
+    plan->crop_x = crop_x;
+    plan->crop_y = crop_y;
+    plan->crop_width = crop_width;
+    plan->crop_height = crop_height;
+    plan->dst_width = dst_width;
+    plan->dst_height = dst_height;
+    plan->xofs = (int*)malloc(n * 2 * sizeof(int));
+    plan->xalpha = (int16_t*)malloc(n * 2 * sizeof(int16_t));
+    plan->yofs = (int*)malloc(dst_height * 2 * sizeof(int));
+    plan->yalpha = (int16_t*)malloc(dst_height * 2 * sizeof(int16_t));
+    plan->rows[0] = (int16_t*)malloc(n * sizeof(int16_t));
+    plan->rows[1] = (int16_t*)malloc(n * sizeof(int16_t));
+    plan->out_row = (unsigned char*)malloc(n);
+    int* xpix = (int*)malloc(dst_width * 2 * sizeof(int));
+    int16_t* xw = (int16_t*)malloc(dst_width * 2 * sizeof(int16_t));
+    if (!plan->xofs || !plan->xalpha || !plan->yofs || !plan->yalpha || !plan->rows[0] || !plan->rows[1] || !plan->out_row || !xpix || !xw) {
+        free(xpix);
+        free(xw);
+        free_plan(plan);
+        return NULL;
+    }
+
+    compute_axis(dst_width, crop_x, crop_width, src_width, xpix, xw);
+    for (int x = 0; x < dst_width; x++) {
+        for (int c = 0; c < channel; c++) {
+            int e = x * channel + c;
+            plan->xofs[e * 2] = xpix[x * 2] * layout->step + layout->ofs[c];
+            plan->xofs[e * 2 + 1] = xpix[x * 2 + 1] * layout->step + layout->ofs[c];
+            plan->xalpha[e * 2] = xw[x * 2];
+            plan->xalpha[e * 2 + 1] = xw[x * 2 + 1];
+        }
+    }
+    compute_axis(dst_height, crop_y, crop_height, src_height, plan->yofs, plan->yalpha);
+    free(xpix);
+    free(xw);
+    return plan;
+}
+
+// 按尺寸从当前线程的缓存中取计划，没有时新建并替换最久未用的一项
+static resize_plan_t* get_plan(int channel, const pixel_layout_t* layout, int src_width, int src_height,
+                               int crop_x, int crop_y, int crop_width, int crop_height,
+                               int dst_width, int dst_height)
+{
+    pthread_once(&plan_cache_once, create_plan_cache_key);
+    resize_plan_cache_t* cache = (resize_plan_cache_t*)pthread_getspecific(plan_cache_key);
+    if (cache == NULL) {
+        cache = (resize_plan_cache_t*)calloc(1, sizeof(resize_plan_cache_t));
+        if (cache == NULL) {
+            return NULL;
+        }
+        pthread_setspecific(plan_cache_key, cache);
+    }
+    cache->tick++;
+
+    int victim = 0;
+    for (int i = 0; i < RESIZE_PLAN_CACHE_SIZE; i++) {
+        resize_plan_t* p = cache->plans[i];
+        if (p != NULL && p->channel == channel && memcmp(&p->layout, layout, sizeof(pixel_layout_t)) == 0 &&
+            p->src_width == src_width && p->src_height == src_height &&
+            p->crop_x == crop_x && p->crop_y == crop_y && p->crop_width == crop_width && p->crop_height == crop_height &&
+            p->dst_width == dst_width && p->dst_height == dst_height) {
+            p->last_used = cache->tick;
+            return p;
+        }
+        if (p == NULL || (cache->plans[victim] != NULL && p->last_used < cache->plans[victim]->last_used)) {
+            victim = i;
+        }
+    }
+
+    resize_plan_t* plan = create_plan(channel, layout, src_width, src_height, crop_x, crop_y, crop_width, crop_height,
+                                      dst_width, dst_height);
+    if (plan == NULL) {
+        return NULL;
+    }
+    free_plan(cache->plans[victim]);
+    cache->plans[victim] = plan;
+    plan->last_used = cache->tick;
+    return plan;
+}
+
+// 水平缩放一行: row[e] = (src[xofs0] * w0 + src[xofs1] * w1) >> RESIZE_ROW_SHIFT
+static void resize_row_h(const unsigned char* src, const int* xofs, const int16_t* xalpha, int16_t* row, int n)
+{
+    int e = 0;
+#if defined(__ARM_NEON)
+    for (; e + 8 <= n; e += 8) {
+        int16_t p0[8], p1[8];
+        for (int k = 0; k < 8; k++) {
+            p0[k] = src[xofs[(e + k) * 2]];
+            p1[k] = src[xofs[(e + k) * 2 + 1]];
+        }
+        int16x8x2_t w = vld2q_s16(xalpha + e * 2);
+        int16x8_t v0 = vld1q_s16(p0);
+        int16x8_t v1 = vld1q_s16(p1);
+        int32x4_t lo = vmull_s16(vget_low_s16(v0), vget_low_s16(w.val[0]));
+        int32x4_t hi = vmull_s16(vget_high_s16(v0), vget_high_s16(w.val[0]));
+        lo = vmlal_s16(lo, vget_low_s16(v1), vget_low_s16(w.val[1]));
+        hi = vmlal_s16(hi, vget_high_s16(v1), vget_high_s16(w.val[1]));
+        vst1q_s16(row + e, vcombine_s16(vrshrn_n_s32(lo, RESIZE_ROW_SHIFT), vrshrn_n_s32(hi, RESIZE_ROW_SHIFT)));
+    }
+#elif defined(__SSE2__)
+    const __m128i round = _mm_set1_epi32(1 << (RESIZE_ROW_SHIFT - 1));
+    for (; e + 8 <= n; e += 8) {
+        const int* o = xofs + e * 2;
+        // 源像素与权重都按 (p0, p1) 交错，_mm_madd_epi16 一次得到 p0 * w0 + p1 * w1
+        __m128i a = _mm_setr_epi16(src[o[0]], src[o[1]], src[o[2]], src[o[3]],
+                                   src[o[4]], src[o[5]], src[o[6]], src[o[7]]);
+        __m128i b = _mm_setr_epi16(src[o[8]], src[o[9]], src[o[10]], src[o[11]],
+                                   src[o[12]], src[o[13]], src[o[14]], src[o[15]]);
+        __m128i lo = _mm_madd_epi16(a, _mm_loadu_si128((const __m128i*)(xalpha + e * 2)));
+        __m128i hi = _mm_madd_epi16(b, _mm_loadu_si128((const __m128i*)(xalpha + e * 2 + 8)));
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, round), RESIZE_ROW_SHIFT);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, round), RESIZE_ROW_SHIFT);
+        _mm_storeu_si128((__m128i*)(row + e), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; e < n; e++) {
+        int v = src[xofs[e * 2]] * xalpha[e * 2] + src[xofs[e * 2 + 1]] * xalpha[e * 2 + 1];
+        row[e] = (int16_t)((v + (1 << (RESIZE_ROW_SHIFT - 1))) >> RESIZE_ROW_SHIFT);
+    }
+}
+
+// 垂直合并两行: dst[e] = (row0[e] * w0 + row1[e] * w1) >> RESIZE_OUT_SHIFT
+static void resize_row_v(const int16_t* row0, const int16_t* row1, int16_t w0, int16_t w1, unsigned char* dst, int n)
+{
+    int e = 0;
+#if defined(__ARM_NEON)
+    for (; e + 8 <= n; e += 8) {
+        int16x8_t a = vld1q_s16(row0 + e);
+        int16x8_t b = vld1q_s16(row1 + e);
+        int32x4_t lo = vmull_n_s16(vget_low_s16(a), w0);
+        int32x4_t hi = vmull_n_s16(vget_high_s16(a), w0);
+        lo = vmlal_n_s16(lo, vget_low_s16(b), w1);
+        hi = vmlal_n_s16(hi, vget_high_s16(b), w1);
+        lo = vrshrq_n_s32(lo, RESIZE_OUT_SHIFT);
+        hi = vrshrq_n_s32(hi, RESIZE_OUT_SHIFT);
+        uint16x8_t v = vcombine_u16(vqmovun_s32(lo), vqmovun_s32(hi));
+        vst1_u8(dst + e, vqmovn_u16(v));
+    }
+#elif defined(__SSE2__)
+    const __m128i w = _mm_set1_epi32((uint16_t)w0 | ((uint32_t)(uint16_t)w1 << 16));
+    const __m128i round = _mm_set1_epi32(1 << (RESIZE_OUT_SHIFT - 1));
+    for (; e + 8 <= n; e += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(row0 + e));
+        __m128i b = _mm_loadu_si128((const __m128i*)(row1 + e));
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w);
+        __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w);
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, round), RESIZE_OUT_SHIFT);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, round), RESIZE_OUT_SHIFT);
+        __m128i v = _mm_packs_epi32(lo, hi);
+        _mm_storel_epi64((__m128i*)(dst + e), _mm_packus_epi16(v, v));
+    }
+#endif
+    for (; e < n; e++) {
+        int v = (row0[e] * w0 + row1[e] * w1 + (1 << (RESIZE_OUT_SHIFT - 1))) >> RESIZE_OUT_SHIFT;
+        dst[e] = (unsigned char)(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+}
+
+// 单通道行扩展为三通道 (灰度 -> RGB)
+static void expand_gray_row(const unsigned char* src, unsigned char* dst, int width)
+{
+    int x = 0;
+#if defined(__ARM_NEON)
+    for (; x + 16 <= width; x += 16) {
+        uint8x16x3_t v;
+        v.val[0] = vld1q_u8(src + x);
+        v.val[1] = v.val[0];
+        v.val[2] = v.val[0];
+        vst3q_u8(dst + x * 3, v);
+    }
+#endif
+    for (; x < width; x++) {
+        dst[x * 3] = src[x];
+        dst[x * 3 + 1] = src[x];
+        dst[x * 3 + 2] = src[x];
+    }
+}
+
+// 取源行 y 的水平缩放结果，与缓存中的行相同时直接复用
+static int16_t* get_row(resize_plan_t* plan, const unsigned char* src, int src_pitch, int y, int slot)
+{
+    int n = plan->dst_width * plan->channel;
+    if (plan->row_y[slot] == y) {
+        return plan->rows[slot];
+    }
+    if (plan->row_y[1 - slot] == y) {
+        // 上一输出行的下邻行成了这一行的上邻行，交换即可
+        int16_t* t = plan->rows[slot];
+        plan->rows[slot] = plan->rows[1 - slot];
+        plan->rows[1 - slot] = t;
+        plan->row_y[1 - slot] = plan->row_y[slot];
+        plan->row_y[slot] = y;
+        return plan->rows[slot];
+    }
+    resize_row_h(src + (size_t)y * src_pitch, plan->xofs, plan->xalpha, plan->rows[slot], n);
+    plan->row_y[slot] = y;
+    return plan->rows[slot];
+}
+
+typedef struct {
+    int channel;
+    const unsigned char* src;
+    int src_width;
+    int src_height;
+    int src_pitch;
+    int crop_x;
+    int crop_y;
+    int crop_width;
+    int crop_height;
+    unsigned char* dst;
+    int dst_width;
+    int dst_height;
+    int dst_pitch;
+    int dst_box_x;
+    int dst_box_y;
+    int dst_box_width;
+    int dst_box_height;
+    int dst_channel;    // 与 channel 不同时只支持 1 -> 3
+    int yuv;            // RESIZE_YUV_*，0 表示普通的多通道图像
+    const unsigned char* src_uv;    // NV12/NV21 的 UV 平面
+} resize_args_t;
+
+// BT.601 有限范围 YUV -> RGB 的 Q10 系数，与 RGA 默认的色彩空间转换一致
+#define YUV_COEF_Y  1192    // 1.164
+#define YUV_COEF_RV 1634    // 1.596
+#define YUV_COEF_GU 401     // 0.391
+#define YUV_COEF_GV 833     // 0.813
+#define YUV_COEF_BU 2066    // 2.018
+
+static inline unsigned char clamp_u8(int v)
+{
+    return (unsigned char)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// 一行亮度和 UV 交错的色度 (已缩放到同一宽度) 转为 RGB888
+static void yuv_row_to_rgb(const unsigned char* y, const unsigned char* uv, unsigned char* dst, int width)
+{
+    int x = 0;
+#if defined(__ARM_NEON)
+    for (; x + 8 <= width; x += 8) {
+        int16x8_t ys = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + x))), vdupq_n_s16(16));
+        uint8x8x2_t c = vld2_u8(uv + x * 2);
+        int16x8_t us = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(c.val[0])), vdupq_n_s16(128));
+        int16x8_t vs = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(c.val[1])), vdupq_n_s16(128));
+
+        int32x4_t yl = vmull_n_s16(vget_low_s16(ys), YUV_COEF_Y);
+        int32x4_t yh = vmull_n_s16(vget_high_s16(ys), YUV_COEF_Y);
+        int32x4_t rl = vmlal_n_s16(yl, vget_low_s16(vs), YUV_COEF_RV);
+        int32x4_t rh = vmlal_n_s16(yh, vget_high_s16(vs), YUV_COEF_RV);
+        int32x4_t gl = vmlsl_n_s16(vmlsl_n_s16(yl, vget_low_s16(us), YUV_COEF_GU), vget_low_s16(vs), YUV_COEF_GV);
+        int32x4_t gh = vmlsl_n_s16(vmlsl_n_s16(yh, vget_high_s16(us), YUV_COEF_GU), vget_high_s16(vs), YUV_COEF_GV);
+        int32x4_t bl = vmlal_n_s16(yl, vget_low_s16(us), YUV_COEF_BU);
+        int32x4_t bh = vmlal_n_s16(yh, vget_high_s16(us), YUV_COEF_BU);
+
+        uint8x8x3_t rgb;
+        rgb.val[0] = vqmovn_u16(vcombine_u16(vqrshrun_n_s32(rl, 10), vqrshrun_n_s32(rh, 10)));
+        rgb.val[1] = vqmovn_u16(vcombine_u16(vqrshrun_n_s32(gl, 10), vqrshrun_n_s32(gh, 10)));
+        rgb.val[2] = vqmovn_u16(vcombine_u16(vqrshrun_n_s32(bl, 10), vqrshrun_n_s32(bh, 10)));
+        vst3_u8(dst + x * 3, rgb);
+    }
+#elif defined(__SSE2__)
+    // 32 位通道里放 (u, v) 一对 16 位值，madd 一次算出一对系数的和
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i coef_y = _mm_set1_epi32(YUV_COEF_Y);
+    const __m128i coef_r = _mm_set1_epi32((uint32_t)YUV_COEF_RV << 16);
+    const __m128i coef_g = _mm_set1_epi32((uint16_t)-YUV_COEF_GU | ((uint32_t)(uint16_t)-YUV_COEF_GV << 16));
+    const __m128i coef_b = _mm_set1_epi32(YUV_COEF_BU);
+    const __m128i round = _mm_set1_epi32(1 << 9);
+    for (; x + 8 <= width; x += 8) {
+        __m128i ys = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(y + x)), zero), _mm_set1_epi16(16));
+        __m128i c = _mm_loadu_si128((const __m128i*)(uv + x * 2));
+        __m128i cl = _mm_sub_epi16(_mm_unpacklo_epi8(c, zero), _mm_set1_epi16(128));
+        __m128i ch = _mm_sub_epi16(_mm_unpackhi_epi8(c, zero), _mm_set1_epi16(128));
+        __m128i yl = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(ys, zero), coef_y), round);
+        __m128i yh = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(ys, zero), coef_y), round);
+
+        __m128i r = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yl, _mm_madd_epi16(cl, coef_r)), 10),
+                                    _mm_srai_epi32(_mm_add_epi32(yh, _mm_madd_epi16(ch, coef_r)), 10));
+        __m128i g = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yl, _mm_madd_epi16(cl, coef_g)), 10),
+                                    _mm_srai_epi32(_mm_add_epi32(yh, _mm_madd_epi16(ch, coef_g)), 10));
+        __m128i b = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yl, _mm_madd_epi16(cl, coef_b)), 10),
+                                    _mm_srai_epi32(_mm_add_epi32(yh, _mm_madd_epi16(ch, coef_b)), 10));
+        unsigned char rb[16], gb[16], bb[16];
+        _mm_storeu_si128((__m128i*)rb, _mm_packus_epi16(r, r));
+        _mm_storeu_si128((__m128i*)gb, _mm_packus_epi16(g, g));
+        _mm_storeu_si128((__m128i*)bb, _mm_packus_epi16(b, b));
+        for (int k = 0; k < 8; k++) {
+            dst[(x + k) * 3] = rb[k];
+            dst[(x + k) * 3 + 1] = gb[k];
+            dst[(x + k) * 3 + 2] = bb[k];
+        }
+    }
+#endif
+    for (; x < width; x++) {
+        int c = (y[x] - 16) * YUV_COEF_Y + (1 << 9);
+        int d = uv[x * 2] - 128;
+        int e = uv[x * 2 + 1] - 128;
+        dst[x * 3] = clamp_u8((c + YUV_COEF_RV * e) >> 10);
+        dst[x * 3 + 1] = clamp_u8((c - YUV_COEF_GU * d - YUV_COEF_GV * e) >> 10);
+        dst[x * 3 + 2] = clamp_u8((c + YUV_COEF_BU * d) >> 10);
+    }
+}
+
+/*
+ * YUV 源: 亮度和色度各用一个计划直接缩放到输出尺寸，逐行转成 RGB 写入目标，
+ * 不需要整幅的中间 RGB 图。色度计划输出 U、V 交错的两个通道。
+ */
+static int resize_yuv_band(const resize_args_t* a, int y_begin, int y_end)
+{
+    int yuyv = a->yuv == RESIZE_YUV_YUYV;
+    pixel_layout_t luma = {yuyv ? 2 : 1, {0, 0, 0, 0}};
+    pixel_layout_t chroma = {2, {0, 1, 0, 0}};
+    if (a->yuv == RESIZE_YUV_NV21) {
+        chroma.ofs[0] = 1;
+        chroma.ofs[1] = 0;
+    } else if (yuyv) {
+        chroma.step = 4;
+        chroma.ofs[0] = 1;
+        chroma.ofs[1] = 3;
+    }
+    // 色度水平方向都是一半分辨率，NV12/NV21 垂直方向也是一半
+    int uv_height = yuyv ? a->src_height : a->src_height / 2;
+    int uv_crop_y = yuyv ? a->crop_y : a->crop_y / 2;
+    int uv_crop_h = yuyv ? a->crop_height : a->crop_height / 2;
+    int uv_crop_w = a->crop_width / 2;
+    const unsigned char* src_uv = yuyv ? a->src : a->src_uv;
+
+    resize_plan_t* lplan = get_plan(1, &luma, a->src_width, a->src_height, a->crop_x, a->crop_y,
+                                    a->crop_width, a->crop_height, a->dst_box_width, a->dst_box_height);
+    resize_plan_t* cplan = get_plan(2, &chroma, a->src_width / 2, uv_height, a->crop_x / 2, uv_crop_y,
+                                    uv_crop_w > 0 ? uv_crop_w : 1, uv_crop_h > 0 ? uv_crop_h : 1,
+                                    a->dst_box_width, a->dst_box_height);
+    if (lplan == NULL || cplan == NULL) {
+        printf("resize plan alloc fail\n");
+        return -1;
+    }
+    lplan->row_y[0] = lplan->row_y[1] = -1;
+    cplan->row_y[0] = cplan->row_y[1] = -1;
+
+    for (int y = y_begin; y < y_end; y++) {
+        int16_t* l0 = get_row(lplan, a->src, a->src_pitch, lplan->yofs[y * 2], 0);
+        int16_t* l1 = get_row(lplan, a->src, a->src_pitch, lplan->yofs[y * 2 + 1], 1);
+        resize_row_v(l0, l1, lplan->yalpha[y * 2], lplan->yalpha[y * 2 + 1], lplan->out_row, a->dst_box_width);
+        int16_t* c0 = get_row(cplan, src_uv, a->src_pitch, cplan->yofs[y * 2], 0);
+        int16_t* c1 = get_row(cplan, src_uv, a->src_pitch, cplan->yofs[y * 2 + 1], 1);
+        resize_row_v(c0, c1, cplan->yalpha[y * 2], cplan->yalpha[y * 2 + 1], cplan->out_row, a->dst_box_width * 2);
+        unsigned char* out = a->dst + (size_t)(a->dst_box_y + y) * a->dst_pitch + a->dst_box_x * 3;
+        yuv_row_to_rgb(lplan->out_row, cplan->out_row, out, a->dst_box_width);
+    }
+    return 0;
+}
+
+// 缩放输出区域的 [y_begin, y_end) 行，计划和行缓存都属于当前线程
+static int resize_band(const resize_args_t* a, int y_begin, int y_end)
+{
+    if (a->yuv != 0) {
+        return resize_yuv_band(a, y_begin, y_end);
+    }
+
+    int n = a->dst_box_width * a->channel;
+    int expand = a->dst_channel != a->channel;
+
+    // 尺寸不变时直接逐行拷贝
+    if (a->crop_width == a->dst_box_width && a->crop_height == a->dst_box_height) {
+        for (int y = y_begin; y < y_end; y++) {
+            const unsigned char* in = a->src + (size_t)(a->crop_y + y) * a->src_pitch + a->crop_x * a->channel;
+            unsigned char* out = a->dst + (size_t)(a->dst_box_y + y) * a->dst_pitch + a->dst_box_x * a->dst_channel;
+            if (expand) {
+                expand_gray_row(in, out, a->dst_box_width);
+            } else {
+                memcpy(out, in, n);
+            }
+        }
+        return 0;
+    }
+
+    pixel_layout_t layout = {a->channel, {0, 1, 2, 3}};
+    resize_plan_t* plan = get_plan(a->channel, &layout, a->src_width, a->src_height, a->crop_x, a->crop_y,
+                                   a->crop_width, a->crop_height, a->dst_box_width, a->dst_box_height);
+    if (plan == NULL) {
+        printf("resize plan alloc fail\n");
+        return -1;
+    }
+    // 源图像内容每次都不同，行缓存只在一次调用内有效
+    plan->row_y[0] = -1;
+    plan->row_y[1] = -1;
+
+    for (int y = y_begin; y < y_end; y++) {
+        int16_t* row0 = get_row(plan, a->src, a->src_pitch, plan->yofs[y * 2], 0);
+        int16_t* row1 = get_row(plan, a->src, a->src_pitch, plan->yofs[y * 2 + 1], 1);
+        unsigned char* out = a->dst + (size_t)(a->dst_box_y + y) * a->dst_pitch + a->dst_box_x * a->dst_channel;
+        if (expand) {
+            resize_row_v(row0, row1, plan->yalpha[y * 2], plan->yalpha[y * 2 + 1], plan->out_row, n);
+            expand_gray_row(plan->out_row, out, a->dst_box_width);
+        } else {
+            resize_row_v(row0, row1, plan->yalpha[y * 2], plan->yalpha[y * 2 + 1], out, n);
+        }
+    }
+    return 0;
+}
+
+/*
+ * 缩放线程池: 输出行按分块分给工作线程，调用线程也参与计算。
+ * 同一时间只服务一个调用者，池被占用时调用者在自己的线程里完成整张图。
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t job_cond;
+    pthread_cond_t done_cond;
+    pthread_mutex_t submit_lock;
+    pthread_t threads[RESIZE_MAX_THREADS];
+    int num_threads;            // 工作线程数 (不含调用线程)
+    int quit;
+    unsigned int generation;    // 每提交一次任务加一
+    const resize_args_t* job;
+    int band_rows;
+    int num_bands;
+    int next_band;              // 下一个待领取的分块
+    int done_bands;             // 已完成的分块数
+    int ret;
+} resize_pool_t;
+
+static resize_pool_t resize_pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .job_cond = PTHREAD_COND_INITIALIZER,
+    .done_cond = PTHREAD_COND_INITIALIZER,
+    .submit_lock = PTHREAD_MUTEX_INITIALIZER,
+};
+static pthread_once_t resize_pool_once = PTHREAD_ONCE_INIT;
+
+// 领取并处理分块，直到当前任务的所有分块都被领走
+static void run_bands(resize_pool_t* pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    while (pool->job != NULL && pool->next_band < pool->num_bands) {
+        const resize_args_t* job = pool->job;
+        int band = pool->next_band++;
+        pthread_mutex_unlock(&pool->lock);
+
+        int y_begin = band * pool->band_rows;
+        int y_end = y_begin + pool->band_rows < job->dst_box_height ? y_begin + pool->band_rows : job->dst_box_height;
+        int ret = resize_band(job, y_begin, y_end);
+
+        pthread_mutex_lock(&pool->lock);
+        if (ret != 0) {
+            pool->ret = -1;
+        }
+        if (++pool->done_bands == pool->num_bands) {
+            pthread_cond_signal(&pool->done_cond);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void* resize_worker(void* arg)
+{
+    resize_pool_t* pool = (resize_pool_t*)arg;
+    pthread_mutex_lock(&pool->lock);
+    unsigned int seen = pool->generation;
+    for (;;) {
+        while (!pool->quit && pool->generation == seen) {
+            pthread_cond_wait(&pool->job_cond, &pool->lock);
+        }
+        if (pool->quit) {
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+        run_bands(pool);
+        pthread_mutex_lock(&pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+// 解析 "4-7" 或 "4,5,6,7" 形式的 CPU 列表
+static int parse_cpu_list(const char* str, int* cpus, int max_cpus)
+{
+    int n = 0;
+    const char* p = str;
+    while (*p != '\0' && n < max_cpus) {
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p) {
+            break;
+        }
+        long last = first;
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p) {
+                break;
+            }
+        }
+        for (long c = first; c <= last && n < max_cpus; c++) {
+            cpus[n++] = (int)c;
+        }
+        if (*end != ',') {
+            break;
+        }
+        p = end + 1;
+    }
+    return n;
+}
+
+static void stop_workers(resize_pool_t* pool)
+{
+    pthread_mutex_lock(&pool->submit_lock);
+    pthread_mutex_lock(&pool->lock);
+    pool->quit = 1;
+    pthread_cond_broadcast(&pool->job_cond);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->num_threads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pool->num_threads = 0;
+    pool->quit = 0;
+    pthread_mutex_unlock(&pool->submit_lock);
+}
+
+static int start_workers(resize_pool_t* pool, int num_threads, const char* cpu_list)
+{
+    stop_workers(pool);
+
+    if (num_threads > RESIZE_MAX_THREADS + 1) {
+        num_threads = RESIZE_MAX_THREADS + 1;
+    }
+    int cpus[CPU_SETSIZE];
+    int num_cpus = 0;
+    if (cpu_list != NULL && cpu_list[0] != '\0') {
+        num_cpus = parse_cpu_list(cpu_list, cpus, CPU_SETSIZE);
+    }
+
+    pthread_mutex_lock(&pool->submit_lock);
+    pool->quit = 0;
+    pool->num_threads = 0;
+    for (int i = 0; i < num_threads - 1; i++) {
+        if (pthread_create(&pool->threads[i], NULL, resize_worker, pool) != 0) {
+            printf("resize worker create fail\n");
+            break;
+        }
+        pool->num_threads++;
+        if (num_cpus > 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int c = 0; c < num_cpus; c++) {
+                if (cpus[c] >= 0 && cpus[c] < CPU_SETSIZE) {
+                    CPU_SET(cpus[c], &set);
+                }
+            }
+            pthread_setaffinity_np(pool->threads[i], sizeof(cpu_set_t), &set);
+        }
+    }
+    int ret = pool->num_threads == num_threads - 1 || num_threads <= 1 ? 0 : -1;
+    pthread_mutex_unlock(&pool->submit_lock);
+    return ret;
+}
+
+// 第一次使用时按环境变量 RESIZE_THREADS / RESIZE_CPUS 创建线程池，默认单线程
+static void init_pool_from_env()
+{
+    char* threads = getenv("RESIZE_THREADS");
+    if (threads != NULL && atoi(threads) > 1) {
+        start_workers(&resize_pool, atoi(threads), getenv("RESIZE_CPUS"));
+    }
+}
+
+int resize_init_threads(int num_threads, const char* cpu_list)
+{
+    pthread_once(&resize_pool_once, init_pool_from_env);
+    return start_workers(&resize_pool, num_threads, cpu_list);
+}
+
+void resize_deinit_threads()
+{
+    pthread_once(&resize_pool_once, init_pool_from_env);
+    stop_workers(&resize_pool);
+}
+
+static int run_resize(const resize_args_t* args);
+
+static int resize_image(int channel, const unsigned char* src, int src_width, int src_height, int src_pitch,
+                        int crop_x, int crop_y, int crop_width, int crop_height,
+                        int dst_channel, unsigned char* dst, int dst_width, int dst_height, int dst_pitch,
+                        int dst_box_x, int dst_box_y, int dst_box_width, int dst_box_height)
+{
+    if (src == NULL || dst == NULL) {
+        printf("resize buffer is null\n");
+        return -1;
+    }
+    if (channel < 1 || channel > 4 || crop_width <= 0 || crop_height <= 0 || dst_box_width <= 0 || dst_box_height <= 0) {
+        printf("resize invalid param channel=%d crop=%dx%d dst=%dx%d\n", channel, crop_width, crop_height,
+               dst_box_width, dst_box_height);
+        return -1;
+    }
+    if (src_pitch < src_width * channel || dst_pitch < dst_width * dst_channel) {
+        printf("resize invalid pitch src=%d dst=%d\n", src_pitch, dst_pitch);
+        return -1;
+    }
+
+    resize_args_t args = {
+        channel, src, src_width, src_height, src_pitch, crop_x, crop_y, crop_width, crop_height,
+        dst, dst_width, dst_height, dst_pitch, dst_box_x, dst_box_y, dst_box_width, dst_box_height, dst_channel,
+        0, NULL,
+    };
+    return run_resize(&args);
+}
+
+// 按输出行分块交给线程池，参数已经检查过
+static int run_resize(const resize_args_t* args)
+{
+    int dst_box_height = args->dst_box_height;
+    resize_pool_t* pool = &resize_pool;
+    pthread_once(&resize_pool_once, init_pool_from_env);
+
+    // 图太小或线程池正被其他调用者使用时，在当前线程完成
+    if (pool->num_threads == 0 || dst_box_height < RESIZE_MIN_BAND_ROWS * 2 ||
+        pthread_mutex_trylock(&pool->submit_lock) != 0) {
+        return resize_band(args, 0, dst_box_height);
+    }
+    if (pool->num_threads == 0) {
+        pthread_mutex_unlock(&pool->submit_lock);
+        return resize_band(args, 0, dst_box_height);
+    }
+
+    int workers = pool->num_threads + 1;
+    int band_rows = (dst_box_height + workers * 2 - 1) / (workers * 2);
+    if (band_rows < RESIZE_MIN_BAND_ROWS) {
+        band_rows = RESIZE_MIN_BAND_ROWS;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->job = args;
+    pool->band_rows = band_rows;
+    pool->num_bands = (dst_box_height + band_rows - 1) / band_rows;
+    pool->next_band = 0;
+    pool->done_bands = 0;
+    pool->ret = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->job_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    run_bands(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->done_bands < pool->num_bands) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+    int ret = pool->ret;
+    pool->job = NULL;
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->submit_lock);
+    return ret;
+}
+
+int resize_bilinear(int channel, const unsigned char* src, int src_width, int src_height, int src_pitch,
+                    int crop_x, int crop_y, int crop_width, int crop_height,
+                    unsigned char* dst, int dst_width, int dst_height, int dst_pitch,
+                    int dst_box_x, int dst_box_y, int dst_box_width, int dst_box_height)
+{
+    return resize_image(channel, src, src_width, src_height, src_pitch, crop_x, crop_y, crop_width, crop_height,
+                        channel, dst, dst_width, dst_height, dst_pitch, dst_box_x, dst_box_y, dst_box_width, dst_box_height);
+}
+
+int resize_bilinear_gray_to_rgb(const unsigned char* src, int src_width, int src_height, int src_pitch,
+                                int crop_x, int crop_y, int crop_width, int crop_height,
+                                unsigned char* dst, int dst_width, int dst_height, int dst_pitch,
+                                int dst_box_x, int dst_box_y, int dst_box_width, int dst_box_height)
+{
+    return resize_image(1, src, src_width, src_height, src_pitch, crop_x, crop_y, crop_width, crop_height,
+                        3, dst, dst_width, dst_height, dst_pitch, dst_box_x, dst_box_y, dst_box_width, dst_box_height);
+}
+
+int resize_yuv_to_rgb(int yuv, const unsigned char* src_y, const unsigned char* src_uv,
+                      int src_width, int src_height, int src_pitch,
+                      int crop_x, int crop_y, int crop_width, int crop_height,
+                      unsigned char* dst, int dst_width, int dst_height, int dst_pitch,
+                      int dst_box_x, int dst_box_y, int dst_box_width, int dst_box_height)
+{
+    if (yuv != RESIZE_YUV_NV12 && yuv != RESIZE_YUV_NV21 && yuv != RESIZE_YUV_YUYV) {
+        printf("resize unsupported yuv layout %d\n", yuv);
+        return -1;
+    }
+    if (src_y == NULL || dst == NULL || (yuv != RESIZE_YUV_YUYV && src_uv == NULL)) {
+        printf("resize buffer is null\n");
+        return -1;
+    }
+    if (crop_width <= 0 || crop_height <= 0 || dst_box_width <= 0 || dst_box_height <= 0) {
+        printf("resize invalid param crop=%dx%d dst=%dx%d\n", crop_width, crop_height, dst_box_width, dst_box_height);
+        return -1;
+    }
+    int src_bytes = yuv == RESIZE_YUV_YUYV ? 2 : 1;
+    if (src_pitch < src_width * src_bytes || dst_pitch < dst_width * 3) {
+        printf("resize invalid pitch src=%d dst=%d\n", src_pitch, dst_pitch);
+        return -1;
+    }
+
+    resize_args_t args = {
+        1, src_y, src_width, src_height, src_pitch, crop_x, crop_y, crop_width, crop_height,
+        dst, dst_width, dst_height, dst_pitch, dst_box_x, dst_box_y, dst_box_width, dst_box_height, 3,
+        yuv, src_uv,
+    };
+    return run_resize(&args);
+}
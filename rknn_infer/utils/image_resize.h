@@ -0,0 +1,100 @@
+#ifndef _RKNN_MODEL_ZOO_IMAGE_RESIZE_H_
+#define _RKNN_MODEL_ZOO_IMAGE_RESIZE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Bilinear resize of a packed 8-bit image region (separable, Q11 fixed point)
+ *
+ * Samples the same source pixels as the float reference (left/top aligned,
+ * edge pixels pair with their inner neighbour), results differ by at most 1.
+ * Coefficient plans are cached per thread by (src, crop, dst, channel).
+ *
+ * @param channel [in] Interleaved channels per pixel (1~4)
+ * @param src [in] Source image
+ * @param src_width [in] Source image width
+ * @param src_height [in] Source image height
+ * @param src_pitch [in] Bytes between source rows (>= src_width * channel)
+ * @param crop_x [in] Crop rectangle on source image
+ * @param crop_y [in]
+ * @param crop_width [in]
+ * @param crop_height [in]
+ * @param dst [out] Target image
+ * @param dst_width [in] Target image width
+ * @param dst_height [in] Target image height
+ * @param dst_pitch [in] Bytes between target rows (>= dst_width * channel)
+ * @param dst_box_x [in] Rectangle on target image to write
+ * @param dst_box_y [in]
+ * @param dst_box_width [in]
+ * @param dst_box_height [in]
+ * @return int 0: success; -1: error
+ */
+int resize_bilinear(int channel, const unsigned char* src, int src_width, int src_height, int src_pitch,
+                    int crop_x, int crop_y, int crop_width, int crop_height,
+                    unsigned char* dst, int dst_width, int dst_height, int dst_pitch,
+                    int dst_box_x, int dst_box_y, int dst_box_width, int dst_box_height);
+
+/**
+ * @brief Bilinear resize of a gray image region into a 3-channel target
+ *
+ * Only one plane is resized, each output row is replicated to R/G/B when it is written,
+ * so the channel expansion costs one extra pass over the (small) target instead of
+ * three channels of resize work.
+ * Parameters are the same as resize_bilinear, src_pitch counts 1 byte and dst_pitch 3 bytes per pixel.
+ *
+ * @return int 0: success; -1: error
+ */
+int resize_bilinear_gray_to_rgb(const unsigned char* src, int src_width, int src_height, int src_pitch,
+                                int crop_x, int crop_y, int crop_width, int crop_height,
+                                unsigned char* dst, int dst_width, int dst_height, int dst_pitch,
+                                int dst_box_x, int dst_box_y, int dst_box_width, int dst_box_height);
+
+// resize_yuv_to_rgb source layouts
+#define RESIZE_YUV_NV12 1
+#define RESIZE_YUV_NV21 2
+#define RESIZE_YUV_YUYV 3
+
+/**
+ * @brief Bilinear resize of a YUV image region into RGB888, color conversion fused into the output rows
+ *
+ * Luma and chroma are resized separately to the target size and converted row by row
+ * (BT.601 limited range, Q10 fixed point), no full-resolution RGB buffer is needed.
+ * Other parameters are the same as resize_bilinear, dst_pitch counts 3 bytes per pixel.
+ *
+ * @param yuv [in] RESIZE_YUV_NV12 / RESIZE_YUV_NV21 / RESIZE_YUV_YUYV
+ * @param src_y [in] Y plane (packed YUYV data for RESIZE_YUV_YUYV)
+ * @param src_uv [in] Interleaved chroma plane of NV12/NV21, same pitch as Y; unused for YUYV
+ * @param src_pitch [in] Bytes between source rows
+ * @return int 0: success; -1: error
+ */
+int resize_yuv_to_rgb(int yuv, const unsigned char* src_y, const unsigned char* src_uv,
+                      int src_width, int src_height, int src_pitch,
+                      int crop_x, int crop_y, int crop_width, int crop_height,
+                      unsigned char* dst, int dst_width, int dst_height, int dst_pitch,
+                      int dst_box_x, int dst_box_y, int dst_box_width, int dst_box_height);
+
+/**
+ * @brief Start the resize worker pool, output rows of resize_bilinear are split into bands
+ *
+ * Without this call the pool is created on first use from the environment:
+ * RESIZE_THREADS (total threads, default 1) and RESIZE_CPUS (e.g. "4-7" for the A76 cores of RK3588).
+ * One caller uses the pool at a time, concurrent callers resize on their own thread.
+ *
+ * @param num_threads [in] Total threads including the caller, <= 1 disables the pool
+ * @param cpu_list [in] CPUs to pin workers to, "4-7" or "4,5,6,7", NULL for no pinning
+ * @return int 0: success; -1: error
+ */
+int resize_init_threads(int num_threads, const char* cpu_list);
+
+/**
+ * @brief Stop the resize worker pool
+ */
+void resize_deinit_threads();
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif // _RKNN_MODEL_ZOO_IMAGE_RESIZE_H_
@@ -0,0 +1,49 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "im2d.h"
+
+#include "image_rga_job.h"
+
+// im2d 的任务接口只有 C++ 版本，这里包一层给 image_utils.c 使用
+int run_rga_convert_job(rga_convert_task_t* tasks, int count)
+{
+    im_job_handle_t job = imbeginJob();
+    if (job <= 0) {
+        printf("RGA imbeginJob fail\n");
+        return -1;
+    }
+
+    rga_buffer_t pat;
+    im_rect prect;
+    memset(&pat, 0, sizeof(rga_buffer_t));
+    memset(&prect, 0, sizeof(im_rect));
+
+    IM_STATUS ret = IM_STATUS_SUCCESS;
+    for (int i = 0; i < count; i++) {
+        rga_convert_task_t* t = &tasks[i];
+        if (t->fill_count > 0) {
+            ret = imfillTaskArray(job, t->dst, t->fill_rects, t->fill_count, t->fill_color);
+            if (ret != IM_STATUS_SUCCESS) {
+                printf("RGA imfillTaskArray fail: %s\n", imStrError(ret));
+                goto err;
+            }
+        }
+        ret = improcessTask(job, t->src, t->dst, pat, t->srect, t->drect, prect, NULL, 0);
+        if (ret != IM_STATUS_SUCCESS) {
+            printf("RGA improcessTask fail: %s\n", imStrError(ret));
+            goto err;
+        }
+    }
+
+    ret = imendJob(job);
+    if (ret != IM_STATUS_SUCCESS) {
+        printf("RGA imendJob fail: %s\n", imStrError(ret));
+        return -1;
+    }
+    return 0;
+
+err:
+    imcancelJob(job);
+    return -1;
+}
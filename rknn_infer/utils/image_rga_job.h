@@ -0,0 +1,39 @@
+#ifndef _RKNN_MODEL_ZOO_IMAGE_RGA_JOB_H_
+#define _RKNN_MODEL_ZOO_IMAGE_RGA_JOB_H_
+
+#include <stdint.h>
+
+#include "im2d_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief One conversion inside an RGA job: pad strips fill, then crop + resize
+ *
+ */
+typedef struct {
+    rga_buffer_t src;
+    rga_buffer_t dst;
+    im_rect srect;
+    im_rect drect;
+    im_rect fill_rects[4];      // Target area outside drect (top/bottom/left/right)
+    int fill_count;
+    uint32_t fill_color;
+} rga_convert_task_t;
+
+/**
+ * @brief Submit conversions as a single synchronous RGA job (im2d task API)
+ *
+ * @param tasks [in] Conversions
+ * @param count [in] Number of conversions
+ * @return int 0: success; -1: error, nothing is guaranteed to be written
+ */
+int run_rga_convert_job(rga_convert_task_t* tasks, int count);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif // _RKNN_MODEL_ZOO_IMAGE_RGA_JOB_H_
@@ -4,12 +4,12 @@
 #include <math.h>
 #include <sys/time.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "im2d.h"
 #include "drmrga.h"
 
 #define STB_IMAGE_IMPLEMENTATION
-#define STBI_NO_THREAD_LOCALS
 #define STBI_ONLY_JPEG
 #define STBI_ONLY_PNG
 #include "stb_image.h"
@@ -18,8 +18,42 @@
 #include "stb_image_write.h"
 
 #include "image_utils.h"
+#include "image_resize.h"
+#include "image_rga_job.h"
+#include "image_buffer_pool.h"
 #include "file_utils.h"
 
+// 解码时分配的行跨距按该像素数对齐，非对齐宽度的图像也能直接交给RGA
+#define IMAGE_STRIDE_ALIGN 16
+#define ALIGN_STRIDE(w) (((w) + IMAGE_STRIDE_ALIGN - 1) / IMAGE_STRIDE_ALIGN * IMAGE_STRIDE_ALIGN)
+
+// width_stride / height_stride 为 0 时表示紧密排列
+static int get_width_stride(const image_buffer_t* image)
+{
+    return image->width_stride > 0 ? image->width_stride : image->width;
+}
+
+static int get_height_stride(const image_buffer_t* image)
+{
+    return image->height_stride > 0 ? image->height_stride : image->height;
+}
+
+// 打包格式每像素字节数，YUV420SP 返回 Y 平面的 1
+static int get_pixel_bytes(image_format_t format)
+{
+    switch (format)
+    {
+    case IMAGE_FORMAT_RGB888:
+        return 3;
+    case IMAGE_FORMAT_RGBA8888:
+        return 4;
+    case IMAGE_FORMAT_YUYV422:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
 static const char* filter_image_names[] = {
     "jpg",
     "jpeg",
@@ -36,102 +70,192 @@ static const char* filter_image_names[] = {
 static const char* subsampName[TJ_NUMSAMP] = {"4:4:4", "4:2:2", "4:2:0", "Grayscale", "4:4:0", "4:1:1"};
 static const char* colorspaceName[TJ_NUMCS] = {"RGB", "YCbCr", "GRAY", "CMYK", "YCCK"};
 
-static int read_image_jpeg(const char* path, image_buffer_t* image)
+// TurboJPEG 句柄每个线程一份，反复使用，线程退出时销毁；多个解码线程之间没有共享状态
+static pthread_key_t tj_decompress_key;
+static pthread_key_t tj_compress_key;
+static pthread_once_t tj_key_once = PTHREAD_ONCE_INIT;
+
+static void destroy_tj_handle(void* handle)
+{
+    tjDestroy((tjhandle)handle);
+}
+
+static void create_tj_keys()
 {
-    FILE* jpegFile = NULL;
-    unsigned long jpegSize;
+    pthread_key_create(&tj_decompress_key, destroy_tj_handle);
+    pthread_key_create(&tj_compress_key, destroy_tj_handle);
+}
+
+static tjhandle get_tj_handle(int compress)
+{
+    pthread_once(&tj_key_once, create_tj_keys);
+    pthread_key_t key = compress ? tj_compress_key : tj_decompress_key;
+    tjhandle handle = (tjhandle)pthread_getspecific(key);
+    if (handle == NULL) {
+        handle = compress ? tjInitCompress() : tjInitDecompress();
+        if (handle == NULL) {
+            printf("tjInit fail: %s\n", tjGetErrorStr2(NULL));
+            return NULL;
+        }
+        pthread_setspecific(key, handle);
+    }
+    return handle;
+}
+
+// 选择输出仍能覆盖 min_width x min_height letterbox 区域的最小缩放因子
+static tjscalingfactor select_jpeg_scale(int width, int height, int min_width, int min_height)
+{
+    tjscalingfactor best = {1, 1};
+    if (min_width <= 0 || min_height <= 0) {
+        return best;
+    }
+    int num = 0;
+    tjscalingfactor* factors = tjGetScalingFactors(&num);
+    for (int i = 0; factors != NULL && i < num; i++) {
+        tjscalingfactor sf = factors[i];
+        if (sf.num > sf.denom || sf.num * best.denom >= best.num * sf.denom) {
+            continue;
+        }
+        if (TJSCALED(width, sf) >= min_width || TJSCALED(height, sf) >= min_height) {
+            best = sf;
+        }
+    }
+    return best;
+}
+
+// 从内存解码 JPEG，jpegBuf 只读，可以直接指向 mmap 的文件内容
+static int decode_jpeg(const unsigned char* jpegBuf, unsigned long size, image_buffer_t* image, int min_width,
+                       int min_height, int decode_flags)
+{
+    int ret = -1;
     int flags = 0;
     int width, height;
     int origin_width, origin_height;
-    unsigned char* imgBuf = NULL;
-    unsigned char* jpegBuf = NULL;
-    unsigned long size;
+    int subsample, colorspace;
     unsigned short orientation = 1;
-    struct timeval tv1, tv2;
+    image_buffer_t out_img;
+    memset(&out_img, 0, sizeof(image_buffer_t));
 
-    if ((jpegFile = fopen(path, "rb")) == NULL) {
-        printf("open input file failure\n");
-    }
-    if (fseek(jpegFile, 0, SEEK_END) < 0 || (size = ftell(jpegFile)) < 0 || fseek(jpegFile, 0, SEEK_SET) < 0) {
-        printf("determining input file size failure\n");
+    tjhandle handle = get_tj_handle(0);
+    if (handle == NULL) {
+        goto out;
     }
-    if (size == 0) {
-        printf("determining input file size, Input file contains no data\n");
+    if (tjDecompressHeader3(handle, (unsigned char*)jpegBuf, size, &origin_width, &origin_height, &subsample, &colorspace) < 0) {
+        printf("header file error, errorStr:%s, errorCode:%d\n", tjGetErrorStr2(handle), tjGetErrorCode(handle));
+        goto out;
     }
-    jpegSize = (unsigned long)size;
-    if ((jpegBuf = (unsigned char*)malloc(jpegSize * sizeof(unsigned char))) == NULL) {
-        printf("allocating JPEG buffer\n");
+    printf("input image: %d x %d, subsampling: %s, colorspace: %s, orientation: %d\n",
+            origin_width, origin_height,
+            subsample >= 0 && subsample < TJ_NUMSAMP ? subsampName[subsample] : "unknown",
+            colorspace >= 0 && colorspace < TJ_NUMCS ? colorspaceName[colorspace] : "unknown", orientation);
+    // DCT 域缩放: 解码时直接输出 1/2、1/4... 尺寸，省掉大部分 IDCT 和后续缩放
+    tjscalingfactor scale = select_jpeg_scale(origin_width, origin_height, min_width, min_height);
+    width = TJSCALED(origin_width, scale);
+    height = TJSCALED(origin_height, scale);
+    if (scale.num != scale.denom) {
+        printf("decode scale %d/%d: %d x %d\n", scale.num, scale.denom, width, height);
     }
-    if (fread(jpegBuf, jpegSize, 1, jpegFile) < 1) {
-        printf("reading input file");
+    if (decode_flags & IMAGE_DECODE_FAST_DCT) {
+        flags |= TJFLAG_FASTDCT;
     }
-    fclose(jpegFile);
-    jpegFile = NULL;
-
-    tjhandle handle = NULL;
-    int subsample, colorspace;
-    int padding = 1;
-    int ret = 0;
-
-    handle = tjInitDecompress();
-    ret = tjDecompressHeader3(handle, jpegBuf, size, &origin_width, &origin_height, &subsample, &colorspace);
-    if (ret < 0) {
-        printf("header file error, errorStr:%s, errorCode:%d\n", tjGetErrorStr(), tjGetErrorCode(handle));
-        return -1;
+    if (decode_flags & IMAGE_DECODE_FAST_UPSAMPLE) {
+        flags |= TJFLAG_FASTUPSAMPLE;
     }
-
-    // 对图像做裁剪16对齐，利于后续rga操作
-    int crop_width = origin_width / 16 * 16;
-    int crop_height = origin_height / 16 * 16;
-
-    printf("origin size=%dx%d crop size=%dx%d\n", origin_width, origin_height, crop_width, crop_height);
-
-    // gettimeofday(&tv1, NULL);
-    ret = tjDecompressHeader3(handle, jpegBuf, size, &width, &height, &subsample, &colorspace);
-    if (ret < 0) {
-        printf("header file error, errorStr:%s, errorCode:%d\n", tjGetErrorStr(), tjGetErrorCode(handle));
-        return -1;
+    // 自行分配时行跨距对齐，调用者提供缓冲时按其 width_stride 写入
+    int width_stride = image->width_stride > 0 ? image->width_stride : width;
+    if (image->virt_addr == NULL) {
+        width_stride = ALIGN_STRIDE(width);
     }
-    printf("input image: %d x %d, subsampling: %s, colorspace: %s, orientation: %d\n", 
-            width, height, subsampName[subsample], colorspaceName[colorspace], orientation);
-    int sw_out_size = width * height * 3;
-    unsigned char* sw_out_buf = image->virt_addr;
-    if (sw_out_buf == NULL) {
-        sw_out_buf = (unsigned char*)malloc(sw_out_size * sizeof(unsigned char));
+    // 灰度 JPEG 自行分配时解码为单通道 GRAY8，解码/缩放/内存流量都只有 RGB 的三分之一
+    int gray = colorspace == TJCS_GRAY && image->virt_addr == NULL;
+    int channel = gray ? 1 : 3;
+    int sw_out_size = width_stride * height * channel;
+    if (image->virt_addr != NULL && image->size > 0 && image->size < sw_out_size) {
+        printf("image buffer too small: %d < %d\n", image->size, sw_out_size);
+        goto out;
     }
-    if (sw_out_buf == NULL) {
+    // 自行分配时从缓冲池取，有 DMA heap 时解码结果直接以 fd 交给 RGA/NPU
+    out_img.width = width;
+    out_img.height = height;
+    out_img.width_stride = width_stride;
+    out_img.format = gray ? IMAGE_FORMAT_GRAY8 : IMAGE_FORMAT_RGB888;
+    out_img.virt_addr = image->virt_addr;
+    out_img.fd = image->fd;
+    if (out_img.virt_addr == NULL && alloc_image_buffer(&out_img) != 0) {
         printf("sw_out_buf is NULL\n");
         goto out;
     }
 
-    flags |= 0;
-
-    // 错误码为0时，表示警告，错误码为-1时表示错误
-    int pixelFormat = TJPF_RGB;
-    ret = tjDecompress2(handle, jpegBuf, size, sw_out_buf, width, 0, height, pixelFormat, flags);
-    // ret = tjDecompressToYUV2(handle, jpeg_buf, size, dst_buf, *width, padding, *height, flags);
-    if ((0 != tjGetErrorCode(handle)) && (ret < 0)) {
-        printf("error : decompress to yuv failed, errorStr:%s, errorCode:%d\n", tjGetErrorStr(),
+    // 返回 -1 且错误码为 TJERR_WARNING 时只是警告，图像仍然可用
+    int pixelFormat = gray ? TJPF_GRAY : TJPF_RGB;
+    sync_image_for_cpu(&out_img);
+    int tj_ret = tjDecompress2(handle, (unsigned char*)jpegBuf, size, out_img.virt_addr, width, width_stride * channel, height,
+                               pixelFormat, flags);
+    sync_image_for_device(&out_img);
+    if (tj_ret < 0 && tjGetErrorCode(handle) != TJERR_WARNING) {
+        printf("error : decompress failed, errorStr:%s, errorCode:%d\n", tjGetErrorStr2(handle),
                tjGetErrorCode(handle));
+        if (image->virt_addr == NULL) {
+            free_image_buffer(&out_img);
+        }
         goto out;
     }
-    if ((0 == tjGetErrorCode(handle)) && (ret < 0)) {
-        printf("warning : errorStr:%s, errorCode:%d\n", tjGetErrorStr(), tjGetErrorCode(handle));
+    if (tj_ret < 0) {
+        printf("warning : errorStr:%s, errorCode:%d\n", tjGetErrorStr2(handle), tjGetErrorCode(handle));
     }
-    tjDestroy(handle);
-    // gettimeofday(&tv2, NULL);
-    // printf("decode time %ld ms\n", (tv2.tv_sec-tv1.tv_sec)*1000 + (tv2.tv_usec-tv1.tv_usec)/1000);
 
     image->width = width;
     image->height = height;
-    image->format = IMAGE_FORMAT_RGB888;
-    image->virt_addr = sw_out_buf;
+    image->width_stride = width_stride;
+    image->height_stride = height;
+    image->orig_width = origin_width;
+    image->orig_height = origin_height;
+    image->format = out_img.format;
+    image->virt_addr = out_img.virt_addr;
+    image->fd = out_img.fd;
     image->size = sw_out_size;
+    ret = 0;
 out:
-    if (jpegBuf) {
-        free(jpegBuf);
+    return ret;
+}
+
+static int read_image_jpeg(const char* path, image_buffer_t* image, int min_width, int min_height, int decode_flags)
+{
+    int ret = -1;
+    unsigned char* jpegBuf = NULL;
+    long size = 0;
+
+    FILE* jpegFile = fopen(path, "rb");
+    if (jpegFile == NULL) {
+        printf("open input file failure: %s\n", path);
+        return -1;
     }
-    return 0;
+    if (fseek(jpegFile, 0, SEEK_END) < 0 || (size = ftell(jpegFile)) < 0 || fseek(jpegFile, 0, SEEK_SET) < 0) {
+        printf("determining input file size failure\n");
+        goto out;
+    }
+    if (size == 0) {
+        printf("determining input file size, Input file contains no data\n");
+        goto out;
+    }
+    if ((jpegBuf = (unsigned char*)malloc(size)) == NULL) {
+        printf("allocating JPEG buffer\n");
+        goto out;
+    }
+    if (fread(jpegBuf, size, 1, jpegFile) < 1) {
+        printf("reading input file\n");
+        goto out;
+    }
+    fclose(jpegFile);
+    jpegFile = NULL;
+
+    ret = decode_jpeg(jpegBuf, size, image, min_width, min_height, decode_flags);
+out:
+    if (jpegFile != NULL) {
+        fclose(jpegFile);
+    }
+    free(jpegBuf);
+    return ret;
 }
 
 static int write_image_jpeg(const char* path, int quality, const image_buffer_t* image)
@@ -147,23 +271,30 @@ static int write_image_jpeg(const char* path, int quality, const image_buffer_t*
     int height = image->height;
     int pixelFormat = TJPF_RGB;
 
-	tjhandle handle = tjInitCompress();
+    tjhandle handle = get_tj_handle(1);
+    if (handle == NULL) {
+        return -1;
+    }
 
     if (image->format == IMAGE_FORMAT_RGB888) {
-        ret = tjCompress2(handle, data, width, 0, height, pixelFormat, &jpegBuf, &jpegSize, jpegSubsamp, quality, flags);
+        ret = tjCompress2(handle, data, width, get_width_stride(image) * 3, height, pixelFormat, &jpegBuf, &jpegSize,
+                          jpegSubsamp, quality, flags);
+    } else if (image->format == IMAGE_FORMAT_GRAY8) {
+        ret = tjCompress2(handle, data, width, get_width_stride(image), height, TJPF_GRAY, &jpegBuf, &jpegSize,
+                          TJSAMP_GRAY, quality, flags);
     } else {
         printf("write_image_jpeg: pixel format %d not support\n", image->format);
         return -1;
     }
 
-	// printf("ret=%d jpegBuf=%p jpegSize=%d\n", ret, jpegBuf, jpegSize);
-    if (jpegBuf != NULL && jpegSize > 0) {
-        write_data_to_file(path, (const char*)jpegBuf, jpegSize);
+    if (ret < 0) {
+        printf("write_image_jpeg: compress fail, errorStr:%s\n", tjGetErrorStr2(handle));
         tjFree(jpegBuf);
+        return -1;
     }
-    tjDestroy(handle);
-
-	return 0;
+    ret = write_data_to_file(path, (const char*)jpegBuf, jpegSize);
+    tjFree(jpegBuf);
+    return ret;
 }
 #endif
 
@@ -188,20 +319,30 @@ static int read_image_raw(const char* path, image_buffer_t* image)
     }
     fseek(fp, 0, SEEK_END);
     int file_size = ftell(fp);
+    if (file_size < 0 || (image->virt_addr != NULL && image->size > 0 && image->size < file_size)) {
+        printf("read %s fail, size %d\n", path, file_size);
+        fclose(fp);
+        return -1;
+    }
     unsigned char *data = image->virt_addr;
     if (image->virt_addr == NULL) {
         data = (unsigned char *)malloc(file_size+1);
+        if (data == NULL) {
+            fclose(fp);
+            return -1;
+        }
+        data[file_size] = 0;
     }
-    data[file_size] = 0;
     fseek(fp, 0, SEEK_SET);
     if(file_size != fread(data, 1, file_size, fp)) {
         printf("fread %s fail!\n", path);
-        free(data);
-        return -1;
-    }
-    if(fp) {
+        if (data != image->virt_addr) {
+            free(data);
+        }
         fclose(fp);
+        return -1;
     }
+    fclose(fp);
     if (image->virt_addr == NULL) {
         image->virt_addr = data;
         image->size = file_size;
@@ -210,6 +351,54 @@ static int read_image_raw(const char* path, image_buffer_t* image)
     return 0;
 }
 
+// stb 的解码结果拷入图像缓冲，并释放 pixeldata
+static int store_stb_pixels(unsigned char* pixeldata, int w, int h, int c, image_buffer_t* image)
+{
+    // 设置图像数据，stb 输出紧密排列，按对齐的行跨距拷入缓冲池的内存(或调用者提供的缓冲)
+    int width_stride = image->width_stride > 0 ? image->width_stride : w;
+    if (image->virt_addr == NULL) {
+        width_stride = ALIGN_STRIDE(w);
+    }
+    image_format_t format = IMAGE_FORMAT_RGB888;
+    if (c == 4) {
+        format = IMAGE_FORMAT_RGBA8888;
+    } else if (c == 1) {
+        format = IMAGE_FORMAT_GRAY8;
+    }
+    int size = width_stride * h * c;
+    image_buffer_t out_img;
+    memset(&out_img, 0, sizeof(image_buffer_t));
+    out_img.width = w;
+    out_img.height = h;
+    out_img.width_stride = width_stride;
+    out_img.format = format;
+    out_img.virt_addr = image->virt_addr;
+    out_img.fd = image->fd;
+    if (out_img.virt_addr == NULL && alloc_image_buffer(&out_img) != 0) {
+        printf("error: alloc size %d fail\n", size);
+        stbi_image_free(pixeldata);
+        return -1;
+    }
+    unsigned char* data = out_img.virt_addr;
+    sync_image_for_cpu(&out_img);
+    for (int y = 0; y < h; y++) {
+        memcpy(data + (size_t)y * width_stride * c, pixeldata + (size_t)y * w * c, w * c);
+    }
+    sync_image_for_device(&out_img);
+    stbi_image_free(pixeldata);
+    image->virt_addr = data;
+    image->fd = out_img.fd;
+    image->width = w;
+    image->height = h;
+    image->width_stride = width_stride;
+    image->height_stride = h;
+    image->orig_width = w;
+    image->orig_height = h;
+    image->size = size;
+    image->format = format;
+    return 0;
+}
+
 static int read_image_stb(const char* path, image_buffer_t* image)
 {
     // 默认图像为3通道
@@ -220,28 +409,23 @@ static int read_image_stb(const char* path, image_buffer_t* image)
         return -1;
     }
     // printf("load image wxhxc=%dx%dx%d path=%s\n", w, h, c, path);
-    int size = w * h * c;
+    return store_stb_pixels(pixeldata, w, h, c, image);
+}
 
-    // 设置图像数据
-    if (image->virt_addr != NULL) {
-        memcpy(image->virt_addr, pixeldata, size);
-        stbi_image_free(pixeldata);
-    } else {
-        image->virt_addr = pixeldata;
-    }
-    image->width = w;
-    image->height = h;
-    if (c == 4) {
-        image->format = IMAGE_FORMAT_RGBA8888;
-    } else if (c == 1) {
-        image->format = IMAGE_FORMAT_GRAY8;
-    } else {
-        image->format = IMAGE_FORMAT_RGB888;
-    }
-    return 0;
+#ifndef DISABLE_LIBJPEG
+// 按 SOI 标记识别 JPEG，不依赖文件扩展名
+static int is_jpeg_data(const unsigned char* data, int size)
+{
+    return size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
 }
+#endif
 
 int read_image(const char* path, image_buffer_t* image)
+{
+    return read_image_scaled(path, image, 0, 0, 0);
+}
+
+int read_image_scaled(const char* path, image_buffer_t* image, int min_width, int min_height, int flags)
 {
     const char* _ext = strrchr(path, '.');
     if (!_ext) {
@@ -253,19 +437,60 @@ int read_image(const char* path, image_buffer_t* image)
 #ifndef DISABLE_LIBJPEG
     } else if (strcmp(_ext, ".jpg") == 0 || strcmp(_ext, ".jpeg") == 0 || strcmp(_ext, ".JPG") == 0 ||
         strcmp(_ext, ".JPEG") == 0) {
-        return read_image_jpeg(path, image);
+        return read_image_jpeg(path, image, min_width, min_height, flags);
 #endif
     } else {
         return read_image_stb(path, image);
     }
 }
 
+int read_image_from_memory(const unsigned char* data, int size, image_buffer_t* image, int min_width, int min_height,
+                           int flags)
+{
+    if (data == NULL || size <= 0) {
+        return -1;
+    }
+#ifndef DISABLE_LIBJPEG
+    if (is_jpeg_data(data, size)) {
+        return decode_jpeg(data, size, image, min_width, min_height, flags);
+    }
+#endif
+    int w, h, c;
+    unsigned char* pixeldata = stbi_load_from_memory(data, size, &w, &h, &c, 0);
+    if (!pixeldata) {
+        printf("error: decode image from memory fail: %s\n", stbi_failure_reason());
+        return -1;
+    }
+    return store_stb_pixels(pixeldata, w, h, c, image);
+}
+
+int get_image_info_from_memory(const unsigned char* data, int size, int* width, int* height, int* channel)
+{
+    if (data == NULL || size <= 0) {
+        return -1;
+    }
+#ifndef DISABLE_LIBJPEG
+    if (is_jpeg_data(data, size)) {
+        int subsample, colorspace;
+        tjhandle handle = get_tj_handle(0);
+        if (handle == NULL ||
+            tjDecompressHeader3(handle, (unsigned char*)data, size, width, height, &subsample, &colorspace) < 0) {
+            return -1;
+        }
+        *channel = colorspace == TJCS_GRAY ? 1 : 3;
+        return 0;
+    }
+#endif
+    return stbi_info_from_memory(data, size, width, height, channel) ? 0 : -1;
+}
+
 int write_image(const char* path, const image_buffer_t* img)
 {
     int ret;
     int width = img->width;
     int height = img->height;
-    int channel = 3;
+    int channel = img->format == IMAGE_FORMAT_GRAY8 ? 1 : 3;
+    int pitch = get_width_stride(img) * channel;
     void* data = img->virt_addr;
     printf("write_image path: %s width=%d height=%d channel=%d data=%p\n",
         path, width, height, channel, data);
@@ -276,8 +501,9 @@ int write_image(const char* path, const image_buffer_t* img)
         return -1;
     }
 
+    // stbi_write_* 成功返回 1，统一为 0: success; -1: error
     if (strcmp(_ext, ".png") == 0 || strcmp(_ext, ".PNG") == 0) {
-        ret = stbi_write_png(path, width, height, channel, data, 0);
+        ret = stbi_write_png(path, width, height, channel, data, pitch) ? 0 : -1;
 
     } else if (strcmp(_ext, ".jpg") == 0 || strcmp(_ext, ".jpeg") == 0 || strcmp(_ext, ".JPG") == 0 ||
         strcmp(_ext, ".JPEG") == 0) {
@@ -285,7 +511,20 @@ int write_image(const char* path, const image_buffer_t* img)
 #ifndef DISABLE_LIBJPEG
         ret = write_image_jpeg(path, quality, img);
 #else
-        ret = stbi_write_jpg(path, width, height, channel, data, quality);
+        // stbi_write_jpg 不支持行跨距，有填充时先去掉
+        if (pitch != width * channel) {
+            unsigned char* packed = (unsigned char*)malloc(width * height * channel);
+            if (packed == NULL) {
+                return -1;
+            }
+            for (int y = 0; y < height; y++) {
+                memcpy(packed + y * width * channel, (unsigned char*)data + (size_t)y * pitch, width * channel);
+            }
+            ret = stbi_write_jpg(path, width, height, channel, packed, quality) ? 0 : -1;
+            free(packed);
+        } else {
+            ret = stbi_write_jpg(path, width, height, channel, data, quality) ? 0 : -1;
+        }
 #endif
     } else if (strcmp(_ext, ".data") == 0 || strcmp(_ext, ".DATA") == 0) {
         int size = get_image_size((image_buffer_t*)img);
@@ -297,94 +536,56 @@ int write_image(const char* path, const image_buffer_t* img)
     return ret;
 }
 
-static int crop_and_scale_image_c(int channel, unsigned char *src, int src_width, int src_height,
-                                    int crop_x, int crop_y, int crop_width, int crop_height,
-                                    unsigned char *dst, int dst_width, int dst_height,
-                                    int dst_box_x, int dst_box_y, int dst_box_width, int dst_box_height) {
-    if (dst == NULL) {
-        printf("dst buffer is null\n");
-        return -1;
-    }
+static int crop_and_scale_image_yuv420sp(image_buffer_t *src, int crop_x, int crop_y, int crop_width, int crop_height,
+                                    image_buffer_t *dst, int dst_box_x, int dst_box_y, int dst_box_width, int dst_box_height) {
 
-    float x_ratio = (float)crop_width / (float)dst_box_width;
-    float y_ratio = (float)crop_height / (float)dst_box_height;
+    // UV 平面紧跟在 Y 平面 (width_stride * height_stride) 之后，行跨距与 Y 相同
+    int src_pitch = get_width_stride(src);
+    int dst_pitch = get_width_stride(dst);
 
-    // printf("src_width=%d src_height=%d crop_x=%d crop_y=%d crop_width=%d crop_height=%d\n",
-    //     src_width, src_height, crop_x, crop_y, crop_width, crop_height);
-    // printf("dst_width=%d dst_height=%d dst_box_x=%d dst_box_y=%d dst_box_width=%d dst_box_height=%d\n",
-    //     dst_width, dst_height, dst_box_x, dst_box_y, dst_box_width, dst_box_height);
-    // printf("channel=%d x_ratio=%f y_ratio=%f\n", channel, x_ratio, y_ratio);
+    unsigned char* src_y = src->virt_addr;
+    unsigned char* src_uv = src_y + src_pitch * get_height_stride(src);
 
-    // 从原图指定区域取数据，双线性缩放到目标指定区域
-    for (int dst_y = dst_box_y; dst_y < dst_box_y + dst_box_height; dst_y++) {
-        for (int dst_x = dst_box_x; dst_x < dst_box_x + dst_box_width; dst_x++) {
-            int dst_x_offset = dst_x - dst_box_x;
-            int dst_y_offset = dst_y - dst_box_y;
-
-            int src_x = (int)(dst_x_offset * x_ratio) + crop_x;
-            int src_y = (int)(dst_y_offset * y_ratio) + crop_y;
-
-            float x_diff = (dst_x_offset * x_ratio) - (src_x - crop_x);
-            float y_diff = (dst_y_offset * y_ratio) - (src_y - crop_y);
-
-            int index1 = src_y * src_width * channel + src_x * channel;
-            int index2 = index1 + src_width * channel;    // down
-            if (src_y == src_height - 1) {
-                // 如果到图像最下边缘，变成选择上面的像素
-                index2 = index1 - src_width * channel;
-            }
-            int index3 = index1 + 1 * channel;            // right
-            int index4 = index2 + 1 * channel;            // down right
-            if (src_x == src_width - 1) {
-                // 如果到图像最右边缘，变成选择左边的像素
-                index3 = index1 - 1 * channel;
-                index4 = index2 - 1 * channel;
-            }
+    unsigned char* dst_y = dst->virt_addr;
+    unsigned char* dst_uv = dst_y + dst_pitch * get_height_stride(dst);
 
-            // printf("dst_x=%d dst_y=%d dst_x_offset=%d dst_y_offset=%d src_x=%d src_y=%d x_diff=%f y_diff=%f src index=%d %d %d %d\n",
-            //     dst_x, dst_y, dst_x_offset, dst_y_offset,
-            //     src_x, src_y, x_diff, y_diff,
-            //     index1, index2, index3, index4);
-
-            for (int c = 0; c < channel; c++) {
-                unsigned char A = src[index1+c];
-                unsigned char B = src[index3+c];
-                unsigned char C = src[index2+c];
-                unsigned char D = src[index4+c];
-
-                unsigned char pixel = (unsigned char)(
-                    A * (1 - x_diff) * (1 - y_diff) +
-                    B * x_diff * (1 - y_diff) +
-                    C * y_diff * (1 - x_diff) +
-                    D * x_diff * y_diff
-                );
-
-                dst[(dst_y * dst_width  + dst_x) * channel + c] = pixel;
-            }
-        }
+    int ret = resize_bilinear(1, src_y, src->width, src->height, src_pitch, crop_x, crop_y, crop_width, crop_height,
+        dst_y, dst->width, dst->height, dst_pitch, dst_box_x, dst_box_y, dst_box_width, dst_box_height);
+    if (ret != 0) {
+        return ret;
     }
 
-    return 0;
+    // UV 平面宽高都是一半，目标区域同样减半
+    return resize_bilinear(2, src_uv, src->width / 2, src->height / 2, src_pitch,
+        crop_x / 2, crop_y / 2, crop_width / 2, crop_height / 2,
+        dst_uv, dst->width / 2, dst->height / 2, dst_pitch,
+        dst_box_x / 2, dst_box_y / 2, dst_box_width / 2, dst_box_height / 2);
 }
 
-static int crop_and_scale_image_yuv420sp(unsigned char *src, int src_width, int src_height,
-                                    int crop_x, int crop_y, int crop_width, int crop_height,
-                                    unsigned char *dst, int dst_width, int dst_height,
-                                    int dst_box_x, int dst_box_y, int dst_box_width, int dst_box_height) {
-
-    unsigned char* src_y = src;
-    unsigned char* src_uv = src + src_width * src_height;
-
-    unsigned char* dst_y = dst;
-    unsigned char* dst_uv = dst + dst_width * dst_height;
-
-    crop_and_scale_image_c(1, src_y, src_width, src_height, crop_x, crop_y, crop_width, crop_height,
-        dst_y, dst_width, dst_height, dst_box_x, dst_box_y, dst_box_width, dst_box_height);
-    
-    crop_and_scale_image_c(2, src_uv, src_width / 2, src_height / 2, crop_x / 2, crop_y / 2, crop_width / 2, crop_height / 2,
-        dst_uv, dst_width / 2, dst_height / 2, dst_box_x, dst_box_y, dst_box_width, dst_box_height);
-
-    return 0;
+// 只填充目标区域之外的边框: 上下整行，中间各行的左右两段
+static void fill_border(unsigned char *dst, int width, int height, int pitch, int channel,
+                        int box_x, int box_y, int box_w, int box_h, char color) {
+    int stride = pitch;
+    int bottom = box_y + box_h;
+    int right_w = (width - box_x - box_w) * channel;
+    if (box_y > 0) {
+        memset(dst, color, (size_t)box_y * stride);
+    }
+    if (bottom < height) {
+        memset(dst + (size_t)bottom * stride, color, (size_t)(height - bottom - 1) * stride + width * channel);
+    }
+    if (box_x == 0 && right_w == 0) {
+        return;
+    }
+    for (int y = box_y; y < bottom; y++) {
+        unsigned char *row = dst + (size_t)y * stride;
+        if (box_x > 0) {
+            memset(row, color, box_x * channel);
+        }
+        if (right_w > 0) {
+            memset(row + (box_x + box_w) * channel, color, right_w);
+        }
+    }
 }
 
 static int convert_image_cpu(image_buffer_t *src, image_buffer_t *dst, image_rect_t *src_box, image_rect_t *dst_box, char color) {
@@ -395,7 +596,20 @@ static int convert_image_cpu(image_buffer_t *src, image_buffer_t *dst, image_rec
     if (src->virt_addr == NULL) {
         return -1;
     }
-    if (src->format != dst->format) {
+    // 灰度源直接写入 RGB 目标时只缩放一个平面，写出时再扩展为三通道
+    int gray_to_rgb = src->format == IMAGE_FORMAT_GRAY8 && dst->format == IMAGE_FORMAT_RGB888;
+    // 相机的 YUV 帧缩放时逐行转为 RGB，不经过整幅的颜色转换缓冲
+    int yuv = 0;
+    if (dst->format == IMAGE_FORMAT_RGB888) {
+        if (src->format == IMAGE_FORMAT_YUV420SP_NV12) {
+            yuv = RESIZE_YUV_NV12;
+        } else if (src->format == IMAGE_FORMAT_YUV420SP_NV21) {
+            yuv = RESIZE_YUV_NV21;
+        } else if (src->format == IMAGE_FORMAT_YUYV422) {
+            yuv = RESIZE_YUV_YUYV;
+        }
+    }
+    if (src->format != dst->format && !gray_to_rgb && yuv == 0) {
         return -1;
     }
 
@@ -420,37 +634,68 @@ static int convert_image_cpu(image_buffer_t *src, image_buffer_t *dst, image_rec
         dst_box_h = dst_box->bottom - dst_box->top + 1;
     }
 
+    int src_pitch = get_width_stride(src) * get_pixel_bytes(src->format);
+    int dst_pitch = get_width_stride(dst) * get_pixel_bytes(dst->format);
+
+    // DMA 缓冲在 CPU 读写前后做缓存同步，RGA/NPU 之后看到的是完整的结果
+    sync_image_for_cpu(src);
+    sync_image_for_cpu(dst);
+
     // fill pad color
     if (dst_box_w != dst->width || dst_box_h != dst->height) {
-        int dst_size = get_image_size(dst);
-        memset(dst->virt_addr, color, dst_size);
+        unsigned char *dst_buf = dst->virt_addr;
+        if (dst->format == IMAGE_FORMAT_RGB888) {
+            fill_border(dst_buf, dst->width, dst->height, dst_pitch, 3, dst_box_x, dst_box_y, dst_box_w, dst_box_h, color);
+        } else if (dst->format == IMAGE_FORMAT_RGBA8888) {
+            fill_border(dst_buf, dst->width, dst->height, dst_pitch, 4, dst_box_x, dst_box_y, dst_box_w, dst_box_h, color);
+        } else if (dst->format == IMAGE_FORMAT_GRAY8) {
+            fill_border(dst_buf, dst->width, dst->height, dst_pitch, 1, dst_box_x, dst_box_y, dst_box_w, dst_box_h, color);
+        } else if (dst->format == IMAGE_FORMAT_YUV420SP_NV12 || dst->format == IMAGE_FORMAT_YUV420SP_NV21) {
+            fill_border(dst_buf, dst->width, dst->height, dst_pitch, 1, dst_box_x, dst_box_y, dst_box_w, dst_box_h, color);
+            fill_border(dst_buf + dst_pitch * get_height_stride(dst), dst->width / 2, dst->height / 2, dst_pitch, 2,
+                dst_box_x / 2, dst_box_y / 2, dst_box_w / 2, dst_box_h / 2, color);
+        } else {
+            int dst_size = get_image_size(dst);
+            memset(dst->virt_addr, color, dst_size);
+        }
     }
 
     int need_release_dst_buffer = 0;
     int reti = 0;
-    if (src->format == IMAGE_FORMAT_RGB888) {
-        reti = crop_and_scale_image_c(3, src->virt_addr, src->width, src->height,
+    if (yuv != 0) {
+        unsigned char* src_uv = src->virt_addr + (size_t)src_pitch * get_height_stride(src);
+        reti = resize_yuv_to_rgb(yuv, src->virt_addr, src_uv, src->width, src->height, src_pitch,
+            src_box_x, src_box_y, src_box_w, src_box_h,
+            dst->virt_addr, dst->width, dst->height, dst_pitch,
+            dst_box_x, dst_box_y, dst_box_w, dst_box_h);
+    } else if (gray_to_rgb) {
+        reti = resize_bilinear_gray_to_rgb(src->virt_addr, src->width, src->height, src_pitch,
+            src_box_x, src_box_y, src_box_w, src_box_h,
+            dst->virt_addr, dst->width, dst->height, dst_pitch,
+            dst_box_x, dst_box_y, dst_box_w, dst_box_h);
+    } else if (src->format == IMAGE_FORMAT_RGB888) {
+        reti = resize_bilinear(3, src->virt_addr, src->width, src->height, src_pitch,
             src_box_x, src_box_y, src_box_w, src_box_h,
-            dst->virt_addr, dst->width, dst->height,
+            dst->virt_addr, dst->width, dst->height, dst_pitch,
             dst_box_x, dst_box_y, dst_box_w, dst_box_h);
     } else if (src->format == IMAGE_FORMAT_RGBA8888) {
-        reti = crop_and_scale_image_c(4, src->virt_addr, src->width, src->height,
+        reti = resize_bilinear(4, src->virt_addr, src->width, src->height, src_pitch,
             src_box_x, src_box_y, src_box_w, src_box_h,
-            dst->virt_addr, dst->width, dst->height,
+            dst->virt_addr, dst->width, dst->height, dst_pitch,
             dst_box_x, dst_box_y, dst_box_w, dst_box_h);
     } else if (src->format == IMAGE_FORMAT_GRAY8) {
-        reti = crop_and_scale_image_c(1, src->virt_addr, src->width, src->height,
+        reti = resize_bilinear(1, src->virt_addr, src->width, src->height, src_pitch,
             src_box_x, src_box_y, src_box_w, src_box_h,
-            dst->virt_addr, dst->width, dst->height,
+            dst->virt_addr, dst->width, dst->height, dst_pitch,
             dst_box_x, dst_box_y, dst_box_w, dst_box_h);
     } else if (src->format == IMAGE_FORMAT_YUV420SP_NV12 || src->format == IMAGE_FORMAT_YUV420SP_NV21) {
-        reti = crop_and_scale_image_yuv420sp(src->virt_addr, src->width, src->height,
-            src_box_x, src_box_y, src_box_w, src_box_h,
-            dst->virt_addr, dst->width, dst->height,
-            dst_box_x, dst_box_y, dst_box_w, dst_box_h);
+        reti = crop_and_scale_image_yuv420sp(src, src_box_x, src_box_y, src_box_w, src_box_h,
+            dst, dst_box_x, dst_box_y, dst_box_w, dst_box_h);
     } else {
         printf("no support format %d\n", src->format);
     }
+    sync_image_for_device(dst);
+    sync_image_for_device(src);
     if (reti != 0) {
         printf("convert_image_cpu fail %d\n", reti);
         return -1;
@@ -470,6 +715,8 @@ static int get_rga_fmt(image_format_t fmt) {
         return RK_FORMAT_YCbCr_420_SP;
     case IMAGE_FORMAT_YUV420SP_NV21:
         return RK_FORMAT_YCrCb_420_SP;
+    case IMAGE_FORMAT_YUYV422:
+        return RK_FORMAT_YUYV_422;
     default:
         return -1;
     }
@@ -480,28 +727,156 @@ int get_image_size(image_buffer_t* image)
     if (image == NULL) {
         return 0;
     }
+    int width_stride = get_width_stride(image);
+    int height_stride = get_height_stride(image);
     switch (image->format)
     {
     case IMAGE_FORMAT_GRAY8:
-        return image->width * image->height;
+        return width_stride * height_stride;
     case IMAGE_FORMAT_RGB888:
-        return image->width * image->height * 3;    
+        return width_stride * height_stride * 3;
     case IMAGE_FORMAT_RGBA8888:
-        return image->width * image->height * 4;
+        return width_stride * height_stride * 4;
     case IMAGE_FORMAT_YUV420SP_NV12:
     case IMAGE_FORMAT_YUV420SP_NV21:
-        return image->width * image->height * 3 / 2;
+        return width_stride * height_stride * 3 / 2;
+    case IMAGE_FORMAT_YUYV422:
+        return width_stride * height_stride * 2;
     default:
         break;
     }
+    return 0;
 }
 
-static int convert_image_rga(image_buffer_t* src_img, image_buffer_t* dst_img, image_rect_t* src_box, image_rect_t* dst_box, char color)
+/*
+ * RGA 句柄缓存: 按 (fd, 行跨距, 格式) 复用 importbuffer_fd 的结果，
+ * 长期存在的 DMA 缓冲 (模型输入、摄像头缓冲) 整个生命周期只导入一次。
+ * 虚拟地址缓冲不缓存，malloc 的帧释放后地址会被复用，缓存的导入会指向旧页面。
+ */
+#define RGA_HANDLE_CACHE_SIZE 16
+
+typedef struct {
+    rga_buffer_handle_t handle;     // 0 表示空项
+    int fd;
+    int width_stride;
+    int height_stride;
+    int format;
+    int refs;                       // 正在使用的转换数，非 0 时不能淘汰
+    int stale;                      // 已失效，最后一个使用者归还时释放
+    unsigned int last_used;
+} rga_handle_entry_t;
+
+static rga_handle_entry_t rga_handle_cache[RGA_HANDLE_CACHE_SIZE];
+static unsigned int rga_handle_tick;
+static pthread_mutex_t rga_handle_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static rga_buffer_handle_t acquire_rga_handle(int fd, im_handle_param_t* param)
+{
+    pthread_mutex_lock(&rga_handle_lock);
+    rga_handle_tick++;
+    int victim = -1;
+    for (int i = 0; i < RGA_HANDLE_CACHE_SIZE; i++) {
+        rga_handle_entry_t* e = &rga_handle_cache[i];
+        if (e->handle > 0 && !e->stale && e->fd == fd && e->width_stride == (int)param->width &&
+            e->height_stride == (int)param->height && e->format == (int)param->format) {
+            e->refs++;
+            e->last_used = rga_handle_tick;
+            pthread_mutex_unlock(&rga_handle_lock);
+            return e->handle;
+        }
+        if (e->handle == 0) {
+            if (victim < 0 || rga_handle_cache[victim].handle > 0) {
+                victim = i;
+            }
+        } else if (e->refs == 0 && (victim < 0 ||
+                   (rga_handle_cache[victim].handle > 0 && e->last_used < rga_handle_cache[victim].last_used))) {
+            victim = i;
+        }
+    }
+
+    rga_buffer_handle_t handle = importbuffer_fd(fd, param);
+    if (handle <= 0 || victim < 0) {
+        // 所有项都在使用中时不缓存，用完由 release_rga_handle 直接释放
+        pthread_mutex_unlock(&rga_handle_lock);
+        return handle;
+    }
+    rga_handle_entry_t* e = &rga_handle_cache[victim];
+    if (e->handle > 0) {
+        releasebuffer_handle(e->handle);
+    }
+    e->handle = handle;
+    e->fd = fd;
+    e->width_stride = param->width;
+    e->height_stride = param->height;
+    e->format = param->format;
+    e->refs = 1;
+    e->stale = 0;
+    e->last_used = rga_handle_tick;
+    pthread_mutex_unlock(&rga_handle_lock);
+    return handle;
+}
+
+// 归还句柄，不在缓存中的句柄直接释放
+static void release_rga_handle(rga_buffer_handle_t handle)
+{
+    pthread_mutex_lock(&rga_handle_lock);
+    for (int i = 0; i < RGA_HANDLE_CACHE_SIZE; i++) {
+        rga_handle_entry_t* e = &rga_handle_cache[i];
+        if (e->handle == handle) {
+            e->refs--;
+            if (e->stale && e->refs == 0) {
+                releasebuffer_handle(e->handle);
+                memset(e, 0, sizeof(rga_handle_entry_t));
+            }
+            pthread_mutex_unlock(&rga_handle_lock);
+            return;
+        }
+    }
+    pthread_mutex_unlock(&rga_handle_lock);
+    releasebuffer_handle(handle);
+}
+
+// 使 fd 对应的缓存项失效，fd < 0 时清空全部
+static void invalidate_rga_handles(int fd)
+{
+    pthread_mutex_lock(&rga_handle_lock);
+    for (int i = 0; i < RGA_HANDLE_CACHE_SIZE; i++) {
+        rga_handle_entry_t* e = &rga_handle_cache[i];
+        if (e->handle <= 0 || (fd >= 0 && e->fd != fd)) {
+            continue;
+        }
+        if (e->refs > 0) {
+            e->stale = 1;
+        } else {
+            releasebuffer_handle(e->handle);
+            memset(e, 0, sizeof(rga_handle_entry_t));
+        }
+    }
+    pthread_mutex_unlock(&rga_handle_lock);
+}
+
+void invalidate_image_handle(image_buffer_t* image)
+{
+    if (image != NULL && image->fd > 0) {
+        invalidate_rga_handles(image->fd);
+    }
+}
+
+void clear_image_handle_cache()
+{
+    invalidate_rga_handles(-1);
+}
+
+// 导入/包装源和目标缓冲，计算裁剪缩放区域和需要填充的边框，句柄用完由 release_rga_task 归还
+static int prepare_rga_task(image_buffer_t* src_img, image_buffer_t* dst_img, image_rect_t* src_box, image_rect_t* dst_box,
+                            char color, rga_convert_task_t* task, rga_buffer_handle_t* handles)
 {
     int ret = 0;
 
     int srcWidth = src_img->width;
     int srcHeight = src_img->height;
+    int srcWstride = get_width_stride(src_img);
+    int srcHstride = get_height_stride(src_img);
     void *src = src_img->virt_addr;
     int src_fd = src_img->fd;
     void *src_phy = NULL;
@@ -509,12 +884,15 @@ static int convert_image_rga(image_buffer_t* src_img, image_buffer_t* dst_img, i
 
     int dstWidth = dst_img->width;
     int dstHeight = dst_img->height;
+    int dstWstride = get_width_stride(dst_img);
+    int dstHstride = get_height_stride(dst_img);
     void *dst = dst_img->virt_addr;
     int dst_fd = dst_img->fd;
     void *dst_phy = NULL;
     int dstFmt = get_rga_fmt(dst_img->format);
-
-    int rotate = 0;
+    if (srcFmt < 0 || dstFmt < 0) {
+        return -1;
+    }
 
     int use_handle = 0;
 #if defined(LIBRGA_IM2D_HANDLE)
@@ -525,19 +903,10 @@ static int convert_image_rga(image_buffer_t* src_img, image_buffer_t* dst_img, i
     //     srcWidth, srcHeight, srcFmt, src, src_fd);
     // printf("dst width=%d height=%d fmt=0x%x virAddr=0x%p fd=%d\n",
     //     dstWidth, dstHeight, dstFmt, dst, dst_fd);
-    // printf("rotate=%d\n", rotate);
-
-    int usage = 0;
-    IM_STATUS ret_rga = IM_STATUS_NOERROR;
-
-    // set rga usage
-    usage |= rotate;
 
     // set rga rect
     im_rect srect;
     im_rect drect;
-    im_rect prect;
-    memset(&prect, 0, sizeof(im_rect));
 
     if (src_box != NULL) {
         srect.x = src_box->left;
@@ -566,26 +935,25 @@ static int convert_image_rga(image_buffer_t* src_img, image_buffer_t* dst_img, i
     // set rga buffer
     rga_buffer_t rga_buf_src;
     rga_buffer_t rga_buf_dst;
-    rga_buffer_t pat;
     rga_buffer_handle_t rga_handle_src = 0;
     rga_buffer_handle_t rga_handle_dst = 0;
-    memset(&pat, 0, sizeof(rga_buffer_t));
 
+    // 导入的缓冲大小和 wrapbuffer 的行跨距都按实际的 stride，未对齐宽度的图像无需重排
     im_handle_param_t in_param;
-    in_param.width = srcWidth;
-    in_param.height = srcHeight;
+    in_param.width = srcWstride;
+    in_param.height = srcHstride;
     in_param.format = srcFmt;
 
     im_handle_param_t dst_param;
-    dst_param.width = dstWidth;
-    dst_param.height = dstHeight;
+    dst_param.width = dstWstride;
+    dst_param.height = dstHstride;
     dst_param.format = dstFmt;
 
     if (use_handle) {
         if (src_phy != NULL) {
             rga_handle_src = importbuffer_physicaladdr((uint64_t)src_phy, &in_param);
         } else if (src_fd > 0) {
-            rga_handle_src = importbuffer_fd(src_fd, &in_param);
+            rga_handle_src = acquire_rga_handle(src_fd, &in_param);
         } else {
             rga_handle_src = importbuffer_virtualaddr(src, &in_param);
         }
@@ -594,14 +962,14 @@ static int convert_image_rga(image_buffer_t* src_img, image_buffer_t* dst_img, i
             ret = -1;
             goto err;
         }
-        rga_buf_src = wrapbuffer_handle(rga_handle_src, srcWidth, srcHeight, srcFmt, srcWidth, srcHeight);
+        rga_buf_src = wrapbuffer_handle(rga_handle_src, srcWidth, srcHeight, srcFmt, srcWstride, srcHstride);
     } else {
         if (src_phy != NULL) {
-            rga_buf_src = wrapbuffer_physicaladdr(src_phy, srcWidth, srcHeight, srcFmt, srcWidth, srcHeight);
+            rga_buf_src = wrapbuffer_physicaladdr(src_phy, srcWidth, srcHeight, srcFmt, srcWstride, srcHstride);
         } else if (src_fd > 0) {
-            rga_buf_src = wrapbuffer_fd(src_fd, srcWidth, srcHeight, srcFmt, srcWidth, srcHeight);
+            rga_buf_src = wrapbuffer_fd(src_fd, srcWidth, srcHeight, srcFmt, srcWstride, srcHstride);
         } else {
-            rga_buf_src = wrapbuffer_virtualaddr(src, srcWidth, srcHeight, srcFmt, srcWidth, srcHeight);
+            rga_buf_src = wrapbuffer_virtualaddr(src, srcWidth, srcHeight, srcFmt, srcWstride, srcHstride);
         }
     }
 
@@ -609,7 +977,7 @@ static int convert_image_rga(image_buffer_t* src_img, image_buffer_t* dst_img, i
         if (dst_phy != NULL) {
             rga_handle_dst = importbuffer_physicaladdr((uint64_t)dst_phy, &dst_param);
         } else if (dst_fd > 0) {
-            rga_handle_dst = importbuffer_fd(dst_fd, &dst_param);
+            rga_handle_dst = acquire_rga_handle(dst_fd, &dst_param);
         } else {
             rga_handle_dst = importbuffer_virtualaddr(dst, &dst_param);
         }
@@ -618,59 +986,101 @@ static int convert_image_rga(image_buffer_t* src_img, image_buffer_t* dst_img, i
             ret = -1;
             goto err;
         }
-        rga_buf_dst = wrapbuffer_handle(rga_handle_dst, dstWidth, dstHeight, dstFmt, dstWidth, dstHeight);
+        rga_buf_dst = wrapbuffer_handle(rga_handle_dst, dstWidth, dstHeight, dstFmt, dstWstride, dstHstride);
     } else {
         if (dst_phy != NULL) {
-            rga_buf_dst = wrapbuffer_physicaladdr(dst_phy, dstWidth, dstHeight, dstFmt, dstWidth, dstHeight);
+            rga_buf_dst = wrapbuffer_physicaladdr(dst_phy, dstWidth, dstHeight, dstFmt, dstWstride, dstHstride);
         } else if (dst_fd > 0) {
-            rga_buf_dst = wrapbuffer_fd(dst_fd, dstWidth, dstHeight, dstFmt, dstWidth, dstHeight);
+            rga_buf_dst = wrapbuffer_fd(dst_fd, dstWidth, dstHeight, dstFmt, dstWstride, dstHstride);
         } else {
-            rga_buf_dst = wrapbuffer_virtualaddr(dst, dstWidth, dstHeight, dstFmt, dstWidth, dstHeight);
-        }
-    }
-
-    if (drect.width != dstWidth || drect.height != dstHeight) {
-        im_rect dst_whole_rect = {0, 0, dstWidth, dstHeight};
-        int imcolor;
-        unsigned char* p_imcolor = (unsigned char*)&imcolor;
-        p_imcolor[0] = color;
-        p_imcolor[1] = color;
-        p_imcolor[2] = color;
-        p_imcolor[3] = color;
-        printf("fill dst image (x y w h)=(%d %d %d %d) with color=0x%x\n",
-            dst_whole_rect.x, dst_whole_rect.y, dst_whole_rect.width, dst_whole_rect.height, imcolor);
-        ret_rga = imfill(rga_buf_dst, dst_whole_rect, imcolor);
-        if (ret_rga <= 0) {
-            if (dst != NULL) {
-                size_t dst_size = get_image_size(dst_img);
-                memset(dst, color, dst_size);
-            } else {
-                printf("Warning: Can not fill color on target image\n");
-            }
+            rga_buf_dst = wrapbuffer_virtualaddr(dst, dstWidth, dstHeight, dstFmt, dstWstride, dstHstride);
         }
     }
 
-    // rga process
-    ret_rga = improcess(rga_buf_src, rga_buf_dst, pat, srect, drect, prect, usage);
-    if (ret_rga <= 0) {
-        printf("Error on improcess STATUS=%d\n", ret_rga);
-        printf("RGA error message: %s\n", imStrError((IM_STATUS)ret_rga));
-        ret = -1;
+    // 只填充目标区域之外的上下整行和左右两段，与缩放放在同一个任务里
+    memset(task, 0, sizeof(rga_convert_task_t));
+    if (drect.y > 0) {
+        im_rect r = {0, 0, dstWidth, drect.y};
+        task->fill_rects[task->fill_count++] = r;
+    }
+    if (drect.y + drect.height < dstHeight) {
+        im_rect r = {0, drect.y + drect.height, dstWidth, dstHeight - drect.y - drect.height};
+        task->fill_rects[task->fill_count++] = r;
     }
+    if (drect.x > 0) {
+        im_rect r = {0, drect.y, drect.x, drect.height};
+        task->fill_rects[task->fill_count++] = r;
+    }
+    if (drect.x + drect.width < dstWidth) {
+        im_rect r = {drect.x + drect.width, drect.y, dstWidth - drect.x - drect.width, drect.height};
+        task->fill_rects[task->fill_count++] = r;
+    }
+    unsigned char* p_imcolor = (unsigned char*)&task->fill_color;
+    p_imcolor[0] = color;
+    p_imcolor[1] = color;
+    p_imcolor[2] = color;
+    p_imcolor[3] = color;
+
+    task->src = rga_buf_src;
+    task->dst = rga_buf_dst;
+    task->srect = srect;
+    task->drect = drect;
+    handles[0] = rga_handle_src;
+    handles[1] = rga_handle_dst;
+    return 0;
 
 err:
     if (rga_handle_src > 0) {
-        releasebuffer_handle(rga_handle_src);
+        release_rga_handle(rga_handle_src);
     }
-
     if (rga_handle_dst > 0) {
-        releasebuffer_handle(rga_handle_dst);
+        release_rga_handle(rga_handle_dst);
+    }
+    return ret;
+}
+
+static void release_rga_task(rga_buffer_handle_t* handles)
+{
+    for (int i = 0; i < 2; i++) {
+        if (handles[i] > 0) {
+            release_rga_handle(handles[i]);
+        }
+        handles[i] = 0;
     }
+}
 
-    // printf("finish\n");
+static int convert_image_rga(image_buffer_t* src_img, image_buffer_t* dst_img, image_rect_t* src_box, image_rect_t* dst_box, char color)
+{
+    rga_convert_task_t task;
+    rga_buffer_handle_t handles[2] = {0, 0};
+    int ret = prepare_rga_task(src_img, dst_img, src_box, dst_box, color, &task, handles);
+    if (ret != 0) {
+        return ret;
+    }
+    ret = run_rga_convert_job(&task, 1);
+    release_rga_task(handles);
     return ret;
 }
 
+#if !defined(DISABLE_RGA)
+// 检查环境变量，如果设置了 RGA_DISABLE 则跳过RGA处理
+static int rga_disabled()
+{
+    char *rga_disable = getenv("RGA_DISABLE");
+    return rga_disable && strcmp(rga_disable, "1") == 0;
+}
+
+// RGA 只要求行跨距对齐，宽度本身可以不对齐
+static int rga_stride_aligned(image_buffer_t* src_img, image_buffer_t* dst_img)
+{
+#if defined(RV1106_1103)
+    return get_width_stride(src_img) % 4 == 0 && get_width_stride(dst_img) % 4 == 0;
+#else
+    return get_width_stride(src_img) % 16 == 0 && get_width_stride(dst_img) % 16 == 0;
+#endif
+}
+#endif
+
 int convert_image(image_buffer_t* src_img, image_buffer_t* dst_img, image_rect_t* src_box, image_rect_t* dst_box, char color)
 {
     int ret;
@@ -678,34 +1088,67 @@ int convert_image(image_buffer_t* src_img, image_buffer_t* dst_img, image_rect_t
     printf("convert image use cpu\n");
     ret = convert_image_cpu(src_img, dst_img, src_box, dst_box, color);
 #else
-    // 检查环境变量，如果设置了 RGA_DISABLE 则跳过RGA处理
-    char *rga_disable = getenv("RGA_DISABLE");
-    if (rga_disable && strcmp(rga_disable, "1") == 0) {
+    if (rga_disabled()) {
         //printf("RGA disabled by environment variable, use cpu\n");
         ret = convert_image_cpu(src_img, dst_img, src_box, dst_box, color);
+    } else if (rga_stride_aligned(src_img, dst_img)) {
+        ret = convert_image_rga(src_img, dst_img, src_box, dst_box, color);
+        if (ret != 0) {
+            //printf("try convert image use cpu\n");
+            ret = convert_image_cpu(src_img, dst_img, src_box, dst_box, color);
+        }
     } else {
-#if defined(RV1106_1103)
-        if(src_img->width % 4 == 0 && dst_img->width % 4 == 0) {
-#else
-        if(src_img->width % 16 == 0 && dst_img->width % 16 == 0) {
+        //printf("src width stride is not 4/16-aligned, convert image use cpu\n");
+        ret = convert_image_cpu(src_img, dst_img, src_box, dst_box, color);
+    }
 #endif
-            ret = convert_image_rga(src_img, dst_img, src_box, dst_box, color);
-            if (ret != 0) {
-                //printf("try convert image use cpu\n");
-                ret = convert_image_cpu(src_img, dst_img, src_box, dst_box, color);
+    return ret;
+}
+
+int convert_image_batch(image_buffer_t** src_images, image_buffer_t** dst_images, image_rect_t* src_boxes,
+                        image_rect_t* dst_boxes, int count, char color)
+{
+    if (count <= 0) {
+        return 0;
+    }
+#if !defined(DISABLE_RGA)
+    if (count <= IMAGE_CONVERT_BATCH_MAX && !rga_disabled()) {
+        rga_convert_task_t tasks[IMAGE_CONVERT_BATCH_MAX];
+        rga_buffer_handle_t handles[IMAGE_CONVERT_BATCH_MAX][2];
+        int n = 0;
+        for (; n < count; n++) {
+            image_rect_t* src_box = src_boxes != NULL ? &src_boxes[n] : NULL;
+            image_rect_t* dst_box = dst_boxes != NULL ? &dst_boxes[n] : NULL;
+            if (!rga_stride_aligned(src_images[n], dst_images[n]) ||
+                prepare_rga_task(src_images[n], dst_images[n], src_box, dst_box, color, &tasks[n], handles[n]) != 0) {
+                break;
             }
-        } else {
-            //printf("src width is not 4/16-aligned, convert image use cpu\n");
-            ret = convert_image_cpu(src_img, dst_img, src_box, dst_box, color);
+        }
+        int ret = n == count ? run_rga_convert_job(tasks, count) : -1;
+        for (int i = 0; i < n; i++) {
+            release_rga_task(handles[i]);
+        }
+        if (ret == 0) {
+            return 0;
         }
     }
 #endif
+    // 不能整批提交时逐帧转换，各帧仍可单独走RGA或回退到CPU
+    int ret = 0;
+    for (int i = 0; i < count; i++) {
+        image_rect_t* src_box = src_boxes != NULL ? &src_boxes[i] : NULL;
+        image_rect_t* dst_box = dst_boxes != NULL ? &dst_boxes[i] : NULL;
+        if (convert_image(src_images[i], dst_images[i], src_box, dst_box, color) != 0) {
+            ret = -1;
+        }
+    }
     return ret;
 }
 
-int convert_image_with_letterbox(image_buffer_t* src_image, image_buffer_t* dst_image, letterbox_t* letterbox, char color)
+// 计算 letterbox 的源/目标区域，目标图像没有缓冲时分配
+static int prepare_letterbox(image_buffer_t* src_image, image_buffer_t* dst_image, letterbox_t* letterbox,
+                             image_rect_t* src_box_out, image_rect_t* dst_box_out)
 {
-    int ret = 0;
     int allow_slight_change = 1;
     int src_w = src_image->width;
     int src_h = src_image->height;
@@ -777,6 +1220,10 @@ int convert_image_with_letterbox(image_buffer_t* src_image, image_buffer_t* dst_
   
     //set offset and scale
     if(letterbox != NULL){
+        // 解码时已缩小的图像，scale 换算到原始尺寸，后处理直接得到原图坐标
+        if (src_image->orig_width > src_w) {
+            scale = scale * src_w / src_image->orig_width;
+        }
         letterbox->scale = scale;
         letterbox->x_pad = _left_offset;
         letterbox->y_pad = _top_offset;
@@ -791,6 +1238,37 @@ int convert_image_with_letterbox(image_buffer_t* src_image, image_buffer_t* dst_
             return -1;
         }
     }
+    *src_box_out = src_box;
+    *dst_box_out = dst_box;
+    return 0;
+}
+
+int convert_image_with_letterbox(image_buffer_t* src_image, image_buffer_t* dst_image, letterbox_t* letterbox, char color)
+{
+    image_rect_t src_box;
+    image_rect_t dst_box;
+    int ret = prepare_letterbox(src_image, dst_image, letterbox, &src_box, &dst_box);
+    if (ret != 0) {
+        return ret;
+    }
     ret = convert_image(src_image, dst_image, &src_box, &dst_box, color);
     return ret;
+}
+
+int convert_image_with_letterbox_batch(image_buffer_t** src_images, image_buffer_t** dst_images, letterbox_t* letterboxes,
+                                       int count, char color)
+{
+    if (count <= 0 || count > IMAGE_CONVERT_BATCH_MAX) {
+        printf("letterbox batch size %d error\n", count);
+        return -1;
+    }
+    image_rect_t src_boxes[IMAGE_CONVERT_BATCH_MAX];
+    image_rect_t dst_boxes[IMAGE_CONVERT_BATCH_MAX];
+    for (int i = 0; i < count; i++) {
+        letterbox_t* letterbox = letterboxes != NULL ? &letterboxes[i] : NULL;
+        if (prepare_letterbox(src_images[i], dst_images[i], letterbox, &src_boxes[i], &dst_boxes[i]) != 0) {
+            return -1;
+        }
+    }
+    return convert_image_batch(src_images, dst_images, src_boxes, dst_boxes, count, color);
 }
\ No newline at end of file
@@ -7,6 +7,18 @@ extern "C" {
 
 #include "common.h"
 
+/*
+ * Thread safety: all functions are reentrant and can run concurrently on different images.
+ * TurboJPEG handles, stb error state and resize plans are per thread; the RGA handle cache and
+ * the image buffer pool are locked internally. One image must not be written by two threads at once.
+ */
+
+#define IMAGE_CONVERT_BATCH_MAX 8
+
+// read_image_scaled flags
+#define IMAGE_DECODE_FAST_DCT       0x1     // TJFLAG_FASTDCT, faster and slightly less accurate IDCT
+#define IMAGE_DECODE_FAST_UPSAMPLE  0x2     // TJFLAG_FASTUPSAMPLE, nearest chroma upsampling
+
 /**
  * @brief LetterBox
  * 
@@ -14,23 +26,70 @@ extern "C" {
 typedef struct {
     int x_pad;
     int y_pad;
-    float scale;
+    float scale;    // target / original size, includes decode-time downscaling (see orig_width)
 } letterbox_t;
 
 /**
  * @brief Read image file (support png/jpeg/bmp)
  * 
  * @param path [in] Image path
- * @param image [out] Read image
+ * @param image [out] Read image, rows are padded to 16 pixels when the buffer is allocated here (see width_stride).
+ *              Grayscale JPEG is decoded as IMAGE_FORMAT_GRAY8 in that case.
+ *              The buffer comes from the image buffer pool (fd set on DMA heap), release it with free_image_buffer
  * @return int 0: success; -1: error
  */
 int read_image(const char* path, image_buffer_t* image);
 
+/**
+ * @brief Read image file, JPEG is decoded at the smallest DCT scaling factor (1/2, 1/4, 1/8...)
+ *        whose output still covers the letterbox area of a min_width x min_height input
+ *
+ * orig_width/orig_height keep the full size, convert_image_with_letterbox folds the decode
+ * scale into letterbox->scale so boxes map back to original coordinates.
+ * Other formats are read at full size.
+ *
+ * @param path [in] Image path
+ * @param image [out] Read image, same as read_image
+ * @param min_width [in] Model input width, 0: full size
+ * @param min_height [in] Model input height, 0: full size
+ * @param flags [in] IMAGE_DECODE_FAST_DCT | IMAGE_DECODE_FAST_UPSAMPLE
+ * @return int 0: success; -1: error
+ */
+int read_image_scaled(const char* path, image_buffer_t* image, int min_width, int min_height, int flags);
+
+/**
+ * @brief Decode an encoded image (JPEG/PNG) from memory, same as read_image_scaled
+ *
+ * JPEG is detected by its SOI marker. data is only read, so it can point into an mmap'ed file.
+ *
+ * @param data [in] Encoded image data
+ * @param size [in] Data size
+ * @param image [out] Decoded image, same as read_image
+ * @param min_width [in] Model input width, 0: full size
+ * @param min_height [in] Model input height, 0: full size
+ * @param flags [in] IMAGE_DECODE_FAST_DCT | IMAGE_DECODE_FAST_UPSAMPLE
+ * @return int 0: success; -1: error
+ */
+int read_image_from_memory(const unsigned char* data, int size, image_buffer_t* image, int min_width, int min_height,
+                           int flags);
+
+/**
+ * @brief Get the size of an encoded image (JPEG/PNG) from its header without decoding
+ *
+ * @param data [in] Encoded image data
+ * @param size [in] Data size
+ * @param width [out] Image width
+ * @param height [out] Image height
+ * @param channel [out] Channels (1 for grayscale JPEG)
+ * @return int 0: success; -1: error
+ */
+int get_image_info_from_memory(const unsigned char* data, int size, int* width, int* height, int* channel);
+
 /**
  * @brief Write image file (support jpg/png)
  * 
  * @param path [in] Image path
- * @param image [in] Image for write (only support IMAGE_FORMAT_RGB888)
+ * @param image [in] Image for write (IMAGE_FORMAT_RGB888 or IMAGE_FORMAT_GRAY8)
  * @return int 0: success; -1: error
  */
 int write_image(const char* path, const image_buffer_t* image);
@@ -58,6 +117,35 @@ int convert_image(image_buffer_t* src_image, image_buffer_t* dst_image, image_re
  */
 int convert_image_with_letterbox(image_buffer_t* src_image, image_buffer_t* dst_image, letterbox_t* letterbox, char color);
 
+/**
+ * @brief Convert several images in one RGA job (pad fill and resize of all frames submitted together)
+ *
+ * Falls back to convert_image per frame when the batch can not go to the RGA as a whole.
+ *
+ * @param src_images [in] Source images
+ * @param dst_images [out] Target images
+ * @param src_boxes [in] Crop rectangles on source images, NULL for whole images
+ * @param dst_boxes [in] Rectangles on target images, NULL for whole images
+ * @param count [in] Number of images (<= IMAGE_CONVERT_BATCH_MAX for a single job)
+ * @param color [in] Pading color if dst_box can not fill target image
+ * @return int 0: success; -1: error
+ */
+int convert_image_batch(image_buffer_t** src_images, image_buffer_t** dst_images, image_rect_t* src_boxes,
+                        image_rect_t* dst_boxes, int count, char color);
+
+/**
+ * @brief Convert several images with letterbox in one RGA job
+ *
+ * @param src_images [in] Source images
+ * @param dst_images [out] Target images
+ * @param letterboxes [out] Letterbox of each image
+ * @param count [in] Number of images (1 ~ IMAGE_CONVERT_BATCH_MAX)
+ * @param color [in] Fill color on target image
+ * @return int 0: success; -1: error
+ */
+int convert_image_with_letterbox_batch(image_buffer_t** src_images, image_buffer_t** dst_images, letterbox_t* letterboxes,
+                                       int count, char color);
+
 /**
  * @brief Get the image size
  * 
@@ -66,6 +154,20 @@ int convert_image_with_letterbox(image_buffer_t* src_image, image_buffer_t* dst_
  */
 int get_image_size(image_buffer_t* image);
 
+/**
+ * @brief Drop cached RGA handles of a DMA buffer, call before closing or reusing its fd
+ *
+ * convert_image imports fd-backed buffers once and keeps the handle in an LRU cache.
+ *
+ * @param image [in] Image whose fd is about to be released
+ */
+void invalidate_image_handle(image_buffer_t* image);
+
+/**
+ * @brief Release all cached RGA handles
+ */
+void clear_image_handle_cache();
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif